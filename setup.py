@@ -1,3 +1,4 @@
+import ctypes.util
 import os
 import platform
 import re
@@ -63,6 +64,11 @@ class CMakeBuild(build_ext):
             "-DPYTHON_EXECUTABLE=" + sys.executable,
         ]
 
+        if os.environ.get("XYRA_IO_URING") == "1":
+            cmake_args += ["-DXYRA_IO_URING=ON"]
+        if os.environ.get("XYRA_TLS") == "1":
+            cmake_args += ["-DXYRA_TLS=ON"]
+
         if "CMAKE_TOOLCHAIN_FILE" in os.environ:
             cmake_args += [
                 "-DCMAKE_TOOLCHAIN_FILE=" + os.environ["CMAKE_TOOLCHAIN_FILE"]
@@ -98,7 +104,7 @@ class CMakeBuild(build_ext):
         # In xyra/native/CMakeLists.txt it might build libxyra.a
         import shutil
 
-        for libname in ("libxyra.a", "xyra.lib", "libxyra.lib", "xyra.a"):
+        for libname in ("libxyra.a", "xyra.lib", "libxyra.lib", "xyra.a", "libxyra_uring.a"):
             lib_path = os.path.join(self.build_temp, libname)
             # On Windows, CMake outputs to a subdirectory based on config (e.g. Release/xyra.lib)
             lib_path_cfg = os.path.join(self.build_temp, cfg, libname)
@@ -134,6 +140,17 @@ class CMakeBuild(build_ext):
         xyra.native.cffi_build.build_cffi(os.path.join(ext.sourcedir, "xyra_cffi.c"))
 
 
+cffi_modules = ["xyra/native/cffi_build.py:ffi"]
+# Same condition as IO_URING in cffi_build.py: the io_uring variant is an
+# extra module, picked at import time by xyra._native.
+if (
+    platform.system() == "Linux"
+    and os.environ.get("XYRA_IO_URING") == "1"
+    and ctypes.util.find_library("uring") is not None
+):
+    cffi_modules.append("xyra/native/cffi_build.py:ffi_uring")
+
+
 setup(
     name="xyra",
     version="0.2.6",
@@ -142,7 +159,7 @@ setup(
     description="High Performance Frameworks, Easy to learn and Ready for Production",
     long_description="",
     ext_modules=[CMakeExtension("xyra._libxyra", sourcedir="xyra/native")],
-    cffi_modules=["xyra/native/cffi_build.py:ffi"],
+    cffi_modules=cffi_modules,
     cmdclass={"build_ext": CMakeBuild},
     include_package_data=True,
     zip_safe=False,
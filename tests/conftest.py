@@ -153,6 +153,8 @@ except ImportError:
 
     mock_libxyra.parse_path.side_effect = mock_parse_path
     mock_lib.xyra_format_cookie.side_effect = mock_xyra_format_cookie
+    # CSRFMiddleware uses its pure Python implementation under the mock
+    mock_lib.xyra_csrf_verify = None
 
     def custom_ffi_string(buf, length):
         if isinstance(buf, bytearray):
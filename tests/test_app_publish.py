@@ -0,0 +1,24 @@
+from unittest.mock import MagicMock, patch
+
+from xyra import App
+
+
+def test_publish_calls_native_app():
+    app = App()
+    app._is_cffi = True
+    app._app = object()
+    mock_lib = MagicMock()
+
+    with patch("xyra.application.lib", mock_lib):
+        assert app.publish("prices", "BTC 1", compress=True) is app
+        app.publish("prices", b"\x00\x01", is_binary=True)
+
+    calls = mock_lib.xyra_app_publish.call_args_list
+    assert calls[0][0] == (app._app, b"prices", 6, b"BTC 1", 5, 1, True)
+    assert calls[1][0] == (app._app, b"prices", 6, b"\x00\x01", 2, 2, False)
+
+
+def test_publish_on_mock_app():
+    app = App()
+    app.publish("chat", "hi")
+    app._app.publish.assert_called_once_with("chat", "hi", False, False)
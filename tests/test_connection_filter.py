@@ -0,0 +1,45 @@
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra import App
+from xyra.middleware import IPFilterMiddleware
+
+
+def test_enable_connection_filter_configures_native_app():
+    app = App()
+    app._is_cffi = True
+    mock_lib = MagicMock()
+    mock_ffi = MagicMock()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        result = app.enable_connection_filter(
+            deny=["203.0.113.0/24"], max_connections_per_ip=32
+        )
+
+    assert result is app
+    mock_lib.xyra_app_set_connection_filter.assert_called_once()
+    args = mock_lib.xyra_app_set_connection_filter.call_args[0]
+    assert args[0] is app._app
+    # No allow list means NULL is passed through
+    assert args[2] is mock_ffi.NULL
+    assert args[3] == 32
+    assert app.middlewares == []
+
+
+def test_enable_connection_filter_falls_back_to_middleware():
+    app = App()
+    app._is_cffi = False
+
+    app.enable_connection_filter(deny=["203.0.113.7"], max_connections_per_ip=8)
+
+    assert len(app.middlewares) == 1
+    middleware = app.middlewares[0]
+    assert isinstance(middleware, IPFilterMiddleware)
+    assert middleware.is_allowed("203.0.113.7") is False
+
+
+def test_enable_connection_filter_rejects_invalid_network():
+    app = App()
+    with pytest.raises(ValueError):
+        app.enable_connection_filter(deny=["300.0.0.1"])
@@ -478,3 +478,26 @@ async def test_csrf_exempt_methods_case_sensitivity():
     # Should be exempt (no status set, not ended)
     response.status.assert_not_called()
     assert response._ended is False
+
+
+@pytest.mark.parametrize("native", [False, True])
+@pytest.mark.parametrize(
+    "header,expected",
+    [
+        ("csrf_token=abc", "abc"),
+        ('other=1; csrf_token="abc"', "abc"),
+        ("csrf_token=abc; csrf_token=abc", "abc"),
+        # Cookie tossing: neither copy is trusted
+        ("csrf_token=attacker; csrf_token=abc", None),
+        ("csrf_token=abc; csrf_token=attacker", None),
+    ],
+)
+def test_csrf_cookie_duplicates_resolve_alike(native, header, expected):
+    middleware = CSRFMiddleware(secret_key="my_secret")
+    if native and not middleware._native:
+        pytest.skip("native extension not built")
+    middleware._native = native
+    request = Mock()
+    request.get_header.return_value = header
+
+    assert middleware._get_cookie(request, "csrf_token") == expected
@@ -1,4 +1,15 @@
-from xyra.datastructures import Headers, QueryParams, has_control_chars
+import socket
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra.datastructures import (
+    Headers,
+    IPSet,
+    QueryParams,
+    has_control_chars,
+    parse_forwarded_element,
+)
 
 
 def test_has_control_chars():
@@ -81,3 +92,73 @@ def test_headers_update():
     other_headers = Headers({"X-Another": "another-value"})
     headers.update(other_headers)
     assert headers["X-Another"] == "another-value"
+
+
+def test_ip_set_membership():
+    ips = IPSet(["10.0.0.0/8", "192.168.1.1/24", "2001:db8::/32"])
+    assert "10.1.2.3" in ips
+    assert "192.168.1.200" in ips
+    assert "2001:db8:1::1" in ips
+    assert "11.0.0.1" not in ips
+    assert "2001:db9::1" not in ips
+    # IPv4-mapped IPv6 matches its IPv4 network
+    assert "::ffff:10.0.0.1" in ips
+    assert "not-an-ip" not in ips
+    assert ips.contains(socket.inet_pton(socket.AF_INET, "10.9.9.9"))
+
+
+def test_ip_set_rejects_invalid_network():
+    with pytest.raises(ValueError):
+        IPSet(["10.0.0.0/33"])
+
+
+def test_ip_set_rejects_network_the_native_set_refuses():
+    mock_lib = MagicMock()
+    mock_lib.xyra_ip_set_add.return_value = False
+
+    with patch("xyra.datastructures._lib", mock_lib), patch("xyra.datastructures._ffi", MagicMock()):
+        with pytest.raises(ValueError, match="10.0.0.0/8"):
+            IPSet(["10.0.0.0/8"])
+
+
+def test_ip_set_resolve_forwarded():
+    trusted = IPSet(["10.0.0.0/8"])
+    assert trusted.resolve_forwarded("1.2.3.4, 10.0.0.2, 10.0.0.3") == ("1.2.3.4", 2)
+    # A fully trusted chain resolves to the originator
+    assert trusted.resolve_forwarded("10.0.0.1, 10.0.0.2") == ("10.0.0.1", 1)
+    # The first untrusted hop must be a valid address
+    assert trusted.resolve_forwarded("1.2.3.4, garbage, 10.0.0.2") == (None, 1)
+
+
+def test_ip_set_resolve_forwarded_normalises_like_native():
+    trusted = IPSet(["10.0.0.0/8"])
+    # The native resolver returns IPv4-mapped clients as plain IPv4
+    assert trusted.resolve_forwarded("::ffff:1.2.3.4, 10.0.0.2") == ("1.2.3.4", 1)
+    assert trusted.resolve_forwarded("2001:DB8:0::1, 10.0.0.2") == ("2001:db8::1", 1)
+
+
+def test_ip_set_native_resolve_reports_peeled_hops_for_invalid_client():
+    mock_lib = MagicMock()
+    mock_ffi = MagicMock()
+    out_len = [0]
+    mock_ffi.new.side_effect = lambda ctype, init=None: out_len if ctype == "size_t*" else bytearray(16)
+    mock_lib.xyra_ip_set_resolve_forwarded.return_value = 1
+
+    with patch("xyra.datastructures._lib", mock_lib), patch("xyra.datastructures._ffi", mock_ffi):
+        trusted = IPSet(["10.0.0.0/8"])
+        assert trusted.resolve_forwarded("1.2.3.4, garbage, 10.0.0.2") == (None, 1)
+
+
+def test_ip_set_resolve_rfc7239_forwarded():
+    trusted = IPSet(["10.0.0.0/8"])
+    chain = 'for=192.0.2.60;proto=https, for="[2001:db8::17]:4711", for=10.0.0.9'
+    assert trusted.resolve_forwarded(chain, rfc7239=True) == ("2001:db8::17", 1)
+
+
+def test_parse_forwarded_element():
+    params = parse_forwarded_element('for="[2001:db8::17]:4711";Proto=https;host=example.com')
+    assert params == {
+        "for": "[2001:db8::17]:4711",
+        "proto": "https",
+        "host": "example.com",
+    }
@@ -0,0 +1,58 @@
+import importlib
+import sys
+from unittest.mock import MagicMock, patch
+
+from xyra import App
+
+
+def load_native(uring_usable=None, environ=None):
+    """Import xyra._native against fake extensions (uring_usable=None: no io_uring build)."""
+    epoll = MagicMock()
+    uring = None
+    if uring_usable is not None:
+        uring = MagicMock()
+        uring.lib.xyra_event_backend_usable.return_value = uring_usable
+    modules = {"xyra._libxyra": epoll, "xyra._libxyra_uring": uring}
+
+    with patch.dict(sys.modules, modules), patch.dict("os.environ", {"XYRA_EVENT_BACKEND": "", **(environ or {})}):
+        sys.modules.pop("xyra._native", None)
+        native = importlib.import_module("xyra._native")
+    return native, epoll, uring
+
+
+def test_io_uring_extension_is_used_when_the_kernel_allows_it():
+    native, _, uring = load_native(uring_usable=True)
+
+    assert native.lib is uring.lib
+    assert native.ffi is uring.ffi
+
+
+def test_falls_back_to_epoll_when_the_kernel_refuses_io_uring():
+    native, epoll, uring = load_native(uring_usable=False)
+
+    uring.lib.xyra_event_backend_usable.assert_called_once()
+    assert native.lib is epoll.lib
+    assert native.ffi is epoll.ffi
+
+
+def test_epoll_only_build_loads_the_epoll_extension():
+    native, epoll, _ = load_native()
+
+    assert native.lib is epoll.lib
+
+
+def test_event_backend_env_forces_epoll():
+    native, epoll, uring = load_native(uring_usable=True, environ={"XYRA_EVENT_BACKEND": "epoll"})
+
+    uring.lib.xyra_event_backend_usable.assert_not_called()
+    assert native.lib is epoll.lib
+
+
+def test_app_creates_native_app():
+    mock_lib = MagicMock()
+
+    with patch("xyra.application.lib", mock_lib):
+        app = App()
+
+    assert app._app is mock_lib.xyra_app_create.return_value
+    mock_lib.xyra_event_backend_usable.assert_not_called()
@@ -0,0 +1,42 @@
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra import App
+
+
+def test_set_http_timeouts_configures_native_app():
+    app = App()
+    app._is_cffi = True
+    mock_lib = MagicMock()
+    mock_ffi = MagicMock()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        assert app.set_http_timeouts(
+            idle_timeout=5, header_timeout=8, body_timeout=30, max_keepalive_requests=1000
+        ) is app
+
+    c_timeouts = mock_ffi.new.return_value
+    mock_ffi.new.assert_called_once_with("xyra_http_timeouts_t*")
+    mock_lib.xyra_app_set_http_timeouts.assert_called_once_with(app._app, c_timeouts)
+    assert (c_timeouts.idle_timeout, c_timeouts.header_timeout, c_timeouts.body_timeout) == (5, 8, 30)
+    assert c_timeouts.max_keepalive_requests == 1000
+
+
+@pytest.mark.parametrize(
+    "kwargs",
+    [{"idle_timeout": -1}, {"header_timeout": 901}, {"body_timeout": 1000}, {"max_keepalive_requests": -1}],
+)
+def test_set_http_timeouts_rejects_out_of_range_values(kwargs):
+    with pytest.raises(ValueError):
+        App().set_http_timeouts(**kwargs)
+
+
+def test_set_http_timeouts_without_native_extension_warns():
+    app = App()
+    app._is_cffi = False
+
+    with patch("xyra.application.get_logger") as mock_get_logger:
+        app.set_http_timeouts(idle_timeout=5)
+
+    mock_get_logger.return_value.warning.assert_called_once()
@@ -126,6 +126,7 @@ def test_websocket_integration():
 
     # Mock socketify WebSocket
     mock_ws = Mock()
+    mock_ws.send.return_value = 1
     ws = WebSocket(mock_ws)
 
     # Test sending message
@@ -0,0 +1,55 @@
+from unittest.mock import MagicMock
+
+import pytest
+
+from xyra.middleware import IPFilterMiddleware, ip_filter
+from xyra.request import Request
+from xyra.response import Response
+
+
+@pytest.fixture
+def mock_req_res():
+    req = MagicMock(spec=Request)
+    res = MagicMock(spec=Response)
+    res._ended = False
+    res.status = MagicMock(return_value=res)
+    res.json = MagicMock(return_value=res)
+    return req, res
+
+
+def test_ip_filter_allow_list(mock_req_res):
+    req, res = mock_req_res
+    middleware = ip_filter(allow=["10.0.0.0/8"])
+
+    req.remote_addr = "10.1.2.3"
+    middleware(req, res)
+    assert res._ended is False
+
+    req.remote_addr = "8.8.8.8"
+    middleware(req, res)
+    res.status.assert_called_with(403)
+    assert res._ended is True
+
+
+def test_ip_filter_deny_takes_precedence():
+    middleware = IPFilterMiddleware(allow=["10.0.0.0/8"], deny=["10.0.0.5"])
+    assert middleware.is_allowed("10.0.0.4") is True
+    assert middleware.is_allowed("10.0.0.5") is False
+
+
+def test_ip_filter_deny_only():
+    middleware = IPFilterMiddleware(deny=["2001:db8::/32"])
+    assert middleware.is_allowed("2001:db8::1") is False
+    assert middleware.is_allowed("2001:db9::1") is True
+    assert middleware.is_allowed("192.0.2.1") is True
+
+
+def test_ip_filter_unknown_address_not_allowed():
+    # SECURITY: an unresolvable client must not slip through an allow list
+    middleware = IPFilterMiddleware(allow=["0.0.0.0/0"])
+    assert middleware.is_allowed("unknown") is False
+
+
+def test_ip_filter_invalid_entry():
+    with pytest.raises(ValueError):
+        IPFilterMiddleware(deny=["not-a-network"])
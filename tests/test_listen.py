@@ -0,0 +1,72 @@
+import os
+import socket
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra import App
+from xyra.application import _prepare_unix_socket
+
+
+def run_native(app, **kwargs):
+    mock_lib = MagicMock()
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi"):
+        app._is_cffi = True
+        app.run_server(graceful_timeout=None, **kwargs)
+    return mock_lib
+
+
+def test_run_server_binds_requested_host():
+    app = App()
+    mock_lib = run_native(app, port=9000, host="::1")
+
+    args = mock_lib.xyra_app_listen_host.call_args[0]
+    assert args[1:4] == (b"::1", 9000, 0)
+    mock_lib.xyra_app_run.assert_called_once_with(app._app)
+
+
+def test_run_server_listens_on_unix_socket():
+    app = App()
+    mock_lib = run_native(app, unix_socket="/tmp/xyra-test.sock")
+
+    assert mock_lib.xyra_app_listen_unix.call_args[0][1] == b"/tmp/xyra-test.sock"
+    mock_lib.xyra_app_listen_host.assert_not_called()
+
+
+def test_reload_child_accepts_from_inherited_socket():
+    app = App()
+    with patch.dict(os.environ, {"XYRA_RELOAD_CHILD": "1", "XYRA_LISTEN_FD": "7"}):
+        mock_lib = run_native(app, unix_socket="/tmp/xyra-test.sock")
+        assert "XYRA_LISTEN_FD" not in os.environ
+
+    assert mock_lib.xyra_app_listen_fd.call_args[0][:2] == (app._app, 7)
+    mock_lib.xyra_app_listen_unix.assert_not_called()
+
+
+def test_prepare_unix_socket_removes_stale_file(tmp_path):
+    path = str(tmp_path / "stale.sock")
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.bind(path)
+    sock.close()
+
+    _prepare_unix_socket(path)
+    assert not os.path.exists(path)
+
+
+def test_prepare_unix_socket_refuses_live_socket(tmp_path):
+    path = str(tmp_path / "live.sock")
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.bind(path)
+    sock.listen(1)
+    try:
+        with pytest.raises(RuntimeError):
+            _prepare_unix_socket(path)
+    finally:
+        sock.close()
+
+
+def test_prepare_unix_socket_refuses_regular_file(tmp_path):
+    path = tmp_path / "file.sock"
+    path.write_text("")
+    with pytest.raises(RuntimeError):
+        _prepare_unix_socket(str(path))
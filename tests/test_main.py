@@ -43,7 +43,9 @@ def test_main_runs_app(mock_parse_args, mock_load_app):
     mock_app = Mock()
     mock_load_app.return_value = mock_app
     mock_parse_args.return_value = Mock(
-        file="main.py", host="localhost", port=8000, reload=False
+        file="main.py", host="localhost", port=8000, reload=False, uds=None, reload_signal=False,
+        workers=1, threads=1, max_requests=0,
+        ssl_certfile=None, ssl_keyfile=None, ssl_keyfile_password=None
     )
 
     # Mock sys.argv to avoid parsing actual command-line arguments
@@ -52,4 +54,40 @@ def test_main_runs_app(mock_parse_args, mock_load_app):
 
     # Check that the app was loaded and run
     mock_load_app.assert_called_with("main.py")
-    mock_app.listen.assert_called_with(port=8000, host="localhost", reload=False)
+    mock_app.listen.assert_called_with(port=8000, host="localhost", threads=1, reload=False)
+
+
+@patch("xyra.__main__.load_app_from_file")
+@patch("argparse.ArgumentParser.parse_args")
+def test_main_listens_on_unix_socket(mock_parse_args, mock_load_app):
+    mock_app = Mock()
+    mock_load_app.return_value = mock_app
+    mock_parse_args.return_value = Mock(
+        file="main.py", host="localhost", port=8000, reload=False, uds="/tmp/xyra.sock", reload_signal=False,
+        workers=1, threads=1, max_requests=0,
+        ssl_certfile=None, ssl_keyfile=None, ssl_keyfile_password=None
+    )
+
+    with patch.object(sys, "argv", ["xyra", "main.py"]):
+        main()
+
+    mock_app.listen.assert_called_with(unix_socket="/tmp/xyra.sock", threads=1, reload=False)
+
+
+@patch("xyra.__main__.load_app_from_file")
+@patch("argparse.ArgumentParser.parse_args")
+def test_main_reload_signal_disables_watching(mock_parse_args, mock_load_app):
+    mock_app = Mock()
+    mock_load_app.return_value = mock_app
+    mock_parse_args.return_value = Mock(
+        file="main.py", host="0.0.0.0", port=80, reload=False, uds=None, reload_signal=True,
+        workers=1, threads=1, max_requests=0,
+        ssl_certfile=None, ssl_keyfile=None, ssl_keyfile_password=None
+    )
+
+    with patch.object(sys, "argv", ["xyra", "main.py"]):
+        main()
+
+    mock_app.listen.assert_called_with(
+        port=80, host="0.0.0.0", threads=1, reload=True, reload_watch=False
+    )
@@ -416,3 +416,30 @@ def test_proxy_headers_valid_chain_resolution():
     mw(request, response)
 
     assert request._host_cache == "client.com"
+
+
+def test_proxy_headers_rfc7239_forwarded():
+    request, response = create_request(
+        "10.0.0.1",
+        {"Forwarded": 'for=1.2.3.4;proto=https;host=example.com:8443, for=10.0.0.2'},
+    )
+
+    mw = proxy_headers(["10.0.0.0/8"])
+    mw(request, response)
+
+    assert request.remote_addr == "1.2.3.4"
+    assert request.scheme == "https"
+    assert request.host == "example.com"
+    assert request.port == 8443
+
+
+def test_proxy_headers_xff_preferred_over_forwarded():
+    request, response = create_request(
+        "10.0.0.1",
+        {"X-Forwarded-For": "5.6.7.8", "Forwarded": "for=1.2.3.4"},
+    )
+
+    mw = proxy_headers(["10.0.0.1"])
+    mw(request, response)
+
+    assert request.remote_addr == "5.6.7.8"
@@ -89,3 +89,61 @@ print("Native bindings OK")
         pytest.fail(
             f"Native bindings test failed:\nSTDOUT:\n{result.stdout}\nSTDERR:\n{result.stderr}"
         )
+
+
+@pytest.mark.integration
+def test_native_csrf_matches_python_subprocess():
+    """Native CSRF helpers must be byte-compatible with the Python fallback."""
+    script = """
+import hashlib
+import hmac
+import sys
+
+from xyra.middleware.csrf import CSRFMiddleware
+
+native = CSRFMiddleware(secret_key="integration-secret")
+if not native._native:
+    print("Native CSRF helpers unavailable (fallback)")
+    sys.exit(0)
+python = CSRFMiddleware(secret_key="integration-secret")
+python._native = False
+
+token = "tok_" + "x" * 40
+signed = native._sign_token(token)
+if signed != python._sign_token(token):
+    print(f"sign mismatch: {signed}")
+    sys.exit(1)
+expected = hmac.new(b"integration-secret", token.encode(), hashlib.sha256).hexdigest()
+if signed != f"{token}.{expected}":
+    print(f"unexpected signature: {signed}")
+    sys.exit(1)
+if native._verify_signed_token(signed) != token:
+    print("verify rejected a valid token")
+    sys.exit(1)
+forged = signed[:-1] + ("1" if signed.endswith("0") else "0")
+if native._verify_signed_token(forged) is not None:
+    print("verify accepted a forged token")
+    sys.exit(1)
+
+for masked in (native._mask_token(signed), python._mask_token(signed)):
+    if native._unmask_token(masked) != signed or python._unmask_token(masked) != signed:
+        print(f"mask round trip failed: {masked}")
+        sys.exit(1)
+
+class Req:
+    def get_header(self, name):
+        return 'a=1; csrf_token="abc.def"; b=2'
+
+if native._get_cookie(Req(), "csrf_token") != "abc.def":
+    print("cookie lookup failed")
+    sys.exit(1)
+
+print("Native CSRF OK")
+"""
+    result = subprocess.run(
+        [sys.executable, "-c", script], capture_output=True, text=True, cwd=os.getcwd()
+    )
+    if result.returncode != 0:
+        pytest.fail(
+            f"Native CSRF test failed:\nSTDOUT:\n{result.stdout}\nSTDERR:\n{result.stderr}"
+        )
@@ -0,0 +1,37 @@
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra import App
+
+
+def test_enable_rate_limit_configures_native_app():
+    app = App()
+    app._is_cffi = True
+    mock_lib = MagicMock()
+
+    with patch("xyra.application.lib", mock_lib):
+        assert app.enable_rate_limit(requests=10, window=5, max_entries=500) is app
+
+    mock_lib.xyra_app_set_rate_limit.assert_called_once_with(app._app, 10, 5, 500)
+    # The native limiter replaces the Python middleware entirely
+    assert app.middlewares == []
+
+
+def test_enable_rate_limit_falls_back_to_middleware():
+    app = App()
+    app._is_cffi = False
+
+    app.enable_rate_limit(requests=3, window=1)
+
+    assert len(app.middlewares) == 1
+    limiter = app.middlewares[0].limiter
+    assert limiter.requests == 3
+    assert limiter.window == 1
+
+
+@pytest.mark.parametrize("requests,window", [(0, 60), (10, 0)])
+def test_enable_rate_limit_rejects_invalid_arguments(requests, window):
+    app = App()
+    with pytest.raises(ValueError):
+        app.enable_rate_limit(requests=requests, window=window)
@@ -0,0 +1,77 @@
+from unittest.mock import MagicMock, patch
+
+from xyra import App, PubSubBus
+from xyra.websockets import WebSocket
+
+
+def test_pubsub_bus_fans_out_to_joined_apps():
+    bus = PubSubBus()
+    first, second = App(), App()
+    first._app, second._app = MagicMock(), MagicMock()
+    first.join_pubsub(bus)
+    second.join_pubsub(bus)
+
+    assert bus.publish("prices", "BTC 1") == 2
+    first._app.publish.assert_called_once_with("prices", "BTC 1", False, False)
+    second._app.publish.assert_called_once_with("prices", "BTC 1", False, False)
+
+
+def test_app_publish_goes_through_joined_bus():
+    bus = PubSubBus()
+    first, second = App(), App()
+    first._app, second._app = MagicMock(), MagicMock()
+    first.join_pubsub(bus)
+    second.join_pubsub(bus)
+
+    first.publish("chat", b"hi", is_binary=True)
+    second._app.publish.assert_called_once_with("chat", b"hi", True, False)
+
+
+def test_native_bus_joins_app():
+    mock_lib = MagicMock()
+    mock_lib.xyra_pubsub_publish.return_value = 3
+    with patch("xyra.websockets.lib", mock_lib), patch("xyra.websockets.ffi", MagicMock()):
+        bus = PubSubBus()
+        assert bus.publish("t", "m", compress=True) == 3
+
+    mock_lib.xyra_pubsub_publish.assert_called_once_with(bus._native, b"t", 1, b"m", 1, 1, True)
+
+    app = App()
+    app._is_cffi = True
+    app._app = object()
+    with patch("xyra.application.lib", mock_lib):
+        app.join_pubsub(bus)
+    mock_lib.xyra_app_join_pubsub.assert_called_once_with(app._app, bus._native)
+    assert bus._apps == []
+
+
+def test_websocket_publish_reaches_other_apps_on_the_bus():
+    bus = PubSubBus()
+    first, second = App(), App()
+    first._app, second._app = MagicMock(), MagicMock()
+    first.join_pubsub(bus)
+    second.join_pubsub(bus)
+
+    first.websocket("/ws", {"message": lambda ws, message, opcode: ws.publish("chat", message)})
+    ws_config = first._app.ws.call_args.args[1]
+    sender = MagicMock()
+    ws_config["message"](sender, "hello", 1)
+
+    # uWS publishes locally without the sender; the bus covers the other loops
+    sender.publish.assert_called_once_with("chat", "hello", False, False)
+    first._app.publish.assert_not_called()
+    second._app.publish.assert_called_once_with("chat", "hello", False, False)
+
+
+def test_native_websocket_publish_is_left_to_the_native_bus():
+    bus = PubSubBus()
+    bus._native = object()
+    app = App()
+    app._pubsub = bus
+    mock_lib = MagicMock()
+    ws_ptr = object()
+
+    with patch("xyra.websockets.lib", mock_lib):
+        WebSocket(ws_ptr, app).publish("chat", "hi")
+
+    mock_lib.xyra_ws_publish.assert_called_once_with(ws_ptr, b"chat", 4, b"hi", 2, False, False)
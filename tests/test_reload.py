@@ -57,3 +57,147 @@ def test_app_reload_subprocess_isolation(mock_watch, mock_popen):
     env = kwargs.get("env")
     assert env is not None
     assert env.get("XYRA_RELOAD_CHILD") == "1"
+
+
+def test_reload_starts_replacement_before_stopping_old_server():
+    import signal
+    import threading
+
+    if not hasattr(signal, "SIGHUP"):
+        return
+
+    app = App()
+    os.environ.pop("XYRA_RELOAD_CHILD", None)
+    events = []
+    old_terminated = threading.Event()
+
+    def fake_popen(cmd, env, **kwargs):
+        proc = MagicMock()
+        proc.poll.return_value = None
+        proc.terminate.side_effect = lambda: (events.append(("terminate", proc)), old_terminated.set())
+        # The child reports readiness over the inherited pipe
+        os.write(int(env["XYRA_READY_FD"]), b"1")
+        events.append(("start", proc))
+        return proc
+
+    class ExitLoopException(Exception):
+        pass
+
+    sleeps = []
+
+    def fake_sleep(seconds):
+        sleeps.append(seconds)
+        if len(sleeps) == 1:
+            os.kill(os.getpid(), signal.SIGHUP)
+            return
+        assert old_terminated.wait(5)
+        raise ExitLoopException
+
+    with patch("subprocess.Popen", side_effect=fake_popen), patch("time.sleep", side_effect=fake_sleep):
+        try:
+            app.run_server(reload=True, reload_watch=False)
+        except ExitLoopException:
+            pass
+
+    first, second = events[0][1], events[1][1]
+    assert events[:2] == [("start", first), ("start", second)]
+    assert ("terminate", first) in events
+    assert ("terminate", second) not in events
+
+
+def test_wait_for_ready_fails_when_child_exits():
+    from xyra.application import _wait_for_ready
+
+    read_fd, write_fd = os.pipe()
+    proc = MagicMock()
+    proc.poll.return_value = 1
+    try:
+        assert _wait_for_ready(read_fd, proc, 5) is False
+    finally:
+        os.close(read_fd)
+        os.close(write_fd)
+
+
+def run_reload_parent(app, fake_popen, **kwargs):
+    class ExitLoopException(Exception):
+        pass
+
+    os.environ.pop("XYRA_RELOAD_CHILD", None)
+    with patch("xyra.application.lib", MagicMock()), \
+            patch("subprocess.Popen", side_effect=fake_popen), \
+            patch("time.sleep", side_effect=ExitLoopException):
+        try:
+            app.run_server(reload=True, reload_watch=False, **kwargs)
+        except ExitLoopException:
+            pass
+
+
+def test_reload_passes_listening_socket_to_server():
+    import socket
+
+    if os.name != "posix":
+        return
+
+    seen = {}
+
+    def fake_popen(cmd, env, pass_fds=(), **kwargs):
+        listen_fd = int(env["XYRA_LISTEN_FD"])
+        assert listen_fd in pass_fds
+        sock = socket.socket(fileno=os.dup(listen_fd))
+        seen["address"] = sock.getsockname()
+        seen["listening"] = sock.getsockopt(socket.SOL_SOCKET, socket.SO_ACCEPTCONN)
+        sock.close()
+        return MagicMock()
+
+    run_reload_parent(App(), fake_popen, host="127.0.0.1", port=0)
+
+    assert seen["address"][0] == "127.0.0.1"
+    assert seen["listening"]
+
+
+def test_reload_reaps_replacement_that_failed_to_start():
+    import signal
+    import threading
+
+    if not hasattr(signal, "SIGHUP"):
+        return
+
+    app = App()
+    os.environ.pop("XYRA_RELOAD_CHILD", None)
+    procs = []
+    reaped = threading.Event()
+
+    def fake_popen(cmd, env, **kwargs):
+        proc = MagicMock()
+        if procs:
+            # The replacement exits before it is ready
+            proc.poll.return_value = 1
+            proc.wait.side_effect = lambda: reaped.set()
+        else:
+            proc.poll.return_value = None
+        procs.append(proc)
+        return proc
+
+    class ExitLoopException(Exception):
+        pass
+
+    sleeps = []
+
+    def fake_sleep(seconds):
+        sleeps.append(seconds)
+        if len(sleeps) == 1:
+            os.kill(os.getpid(), signal.SIGHUP)
+            return
+        assert reaped.wait(5)
+        raise ExitLoopException
+
+    with patch("subprocess.Popen", side_effect=fake_popen), patch("time.sleep", side_effect=fake_sleep):
+        try:
+            app.run_server(reload=True, reload_watch=False)
+        except ExitLoopException:
+            pass
+
+    first, second = procs
+    second.terminate.assert_called_once()
+    second.wait.assert_called_once()
+    first.terminate.assert_not_called()
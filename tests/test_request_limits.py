@@ -0,0 +1,89 @@
+from types import SimpleNamespace
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra import App
+
+
+def test_enable_request_limits_configures_native_app():
+    app = App()
+    app._is_cffi = True
+    mock_lib = MagicMock()
+    mock_ffi = MagicMock()
+    c_limits = MagicMock()
+    mock_ffi.new.return_value = c_limits
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        assert (
+            app.enable_request_limits(
+                max_headers=50,
+                max_header_bytes=4096,
+                max_url_length=2048,
+                max_query_fields=20,
+                max_body_size=1024,
+            )
+            is app
+        )
+
+    mock_ffi.new.assert_called_once_with("xyra_request_limits_t*")
+    assert c_limits.max_headers == 50
+    assert c_limits.max_header_bytes == 4096
+    assert c_limits.max_url_length == 2048
+    assert c_limits.max_query_fields == 20
+    assert c_limits.max_body_size == 1024
+    mock_lib.xyra_app_set_request_limits.assert_called_once_with(app._app, c_limits)
+
+
+def test_enable_request_limits_rejects_negative_values():
+    app = App()
+    with pytest.raises(ValueError):
+        app.enable_request_limits(max_url_length=-1)
+
+
+def register_native(app):
+    mock_lib = MagicMock(spec=["xyra_app_get", "xyra_app_post", "xyra_app_put", "xyra_app_any"])
+    mock_ffi = MagicMock()
+    mock_ffi.new.side_effect = lambda ctype: SimpleNamespace()
+    app._app = object()
+    app._is_cffi = True
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        app._register_routes()
+    return mock_lib, mock_ffi
+
+
+def test_route_max_body_size_applies_to_its_method_only():
+    app = App()
+
+    @app.get("/upload")
+    def show(req, res):
+        res.send("ok")
+
+    @app.post("/upload", max_body_size=4096)
+    def upload(req, res):
+        res.send("ok")
+
+    @app.put("/upload")
+    def replace(req, res):
+        res.send("ok")
+
+    mock_lib, mock_ffi = register_native(app)
+
+    (post_args,) = [call.args for call in mock_lib.xyra_app_post.call_args_list]
+    assert post_args[1] == b"/upload"
+    assert (post_args[4].has_max_body_size, post_args[4].max_body_size) == (True, 4096)
+    for c_method in (mock_lib.xyra_app_get, mock_lib.xyra_app_put):
+        assert c_method.call_args.args[4] is mock_ffi.NULL
+
+
+def test_route_max_body_size_zero_lifts_app_limit():
+    app = App()
+
+    @app.post("/stream", max_body_size=0)
+    def stream(req, res):
+        res.send("ok")
+
+    mock_lib, _ = register_native(app)
+
+    c_options = mock_lib.xyra_app_post.call_args.args[4]
+    assert (c_options.has_max_body_size, c_options.max_body_size) == (True, 0)
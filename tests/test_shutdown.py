@@ -0,0 +1,106 @@
+import asyncio
+import subprocess
+import sys
+import textwrap
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra import App
+
+
+def test_shutdown_calls_native_with_milliseconds():
+    app = App()
+    app._is_cffi = True
+    mock_lib = MagicMock()
+
+    with patch("xyra.application.lib", mock_lib):
+        app.shutdown(2.5)
+
+    mock_lib.xyra_app_shutdown.assert_called_once_with(app._app, 2500)
+    assert app._shutdown_timeout == 2.5
+
+
+def test_shutdown_falls_back_to_close():
+    app = App()
+    app._is_cffi = False
+    app._app = MagicMock()
+
+    app.shutdown()
+    app._app.close.assert_called_once_with()
+
+
+def test_shutdown_rejects_negative_timeout():
+    with pytest.raises(ValueError):
+        App().shutdown(-1)
+
+
+def test_drain_async_tasks_waits_for_pending_handlers():
+    app = App()
+    loop = app._get_loop()
+    finished = []
+
+    async def handler():
+        await asyncio.sleep(0.05)
+        finished.append(True)
+
+    asyncio.run_coroutine_threadsafe(handler(), loop)
+    app._drain_async_tasks(5)
+    assert finished == [True]
+
+
+@pytest.mark.skipif(sys.platform == "win32", reason="POSIX signals only")
+def test_sigterm_triggers_graceful_shutdown():
+    script = textwrap.dedent(
+        """
+        import os, signal, threading
+        from xyra import App
+
+        app = App.__new__(App)  # no native core in this subprocess
+        done = threading.Event()
+        app.shutdown = lambda timeout: (print("shutdown", timeout), done.set())
+        app._shutdown_on_sigterm(7.0)
+        os.kill(os.getpid(), signal.SIGTERM)
+        assert done.wait(5)
+        """
+    )
+    result = subprocess.run(
+        [sys.executable, "-c", script], capture_output=True, text=True, timeout=30
+    )
+    assert result.returncode == 0, result.stderr
+    assert "shutdown 7.0" in result.stdout
+
+
+@pytest.mark.skipif(sys.platform == "win32", reason="POSIX signals only")
+def test_second_sigterm_cuts_drain_short_and_handler_is_restored():
+    script = textwrap.dedent(
+        """
+        import os, signal, threading
+        from xyra import App
+
+        app = App.__new__(App)  # no native core in this subprocess
+        drained, closed = threading.Event(), threading.Event()
+        app.shutdown = lambda timeout: drained.set()
+        app._close_now = closed.set
+        restore = app._shutdown_on_sigterm(30.0)
+
+        # Nothing is blocked, so subprocesses of handlers stay killable
+        assert signal.SIGTERM not in signal.pthread_sigmask(signal.SIG_BLOCK, [])
+        os.kill(os.getpid(), signal.SIGTERM)
+        assert drained.wait(5)
+        assert not closed.is_set()
+        os.kill(os.getpid(), signal.SIGTERM)
+        assert closed.wait(5)
+
+        restore()
+        assert signal.getsignal(signal.SIGTERM) is signal.SIG_DFL
+        assert signal.set_wakeup_fd(-1) == -1
+        print("ok")
+        """
+    )
+    result = subprocess.run(
+        [sys.executable, "-c", script], capture_output=True, text=True, timeout=30
+    )
+    assert result.returncode == 0, result.stderr
+    assert "ok" in result.stdout
+
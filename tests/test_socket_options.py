@@ -0,0 +1,52 @@
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra import App
+
+
+def test_set_socket_options_configures_native_app():
+    app = App()
+    app._is_cffi = True
+    mock_lib = MagicMock()
+    mock_ffi = MagicMock()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        assert app.set_socket_options(
+            tcp_nodelay=False, tcp_fastopen=256, defer_accept=5, busy_poll=50,
+            recv_buffer=65536, send_buffer=131072, backlog=4096,
+        ) is app
+
+    c_options = mock_ffi.new.return_value
+    mock_ffi.new.assert_called_once_with("xyra_socket_options_t*")
+    mock_lib.xyra_app_set_socket_options.assert_called_once_with(app._app, c_options)
+    assert (c_options.backlog, c_options.tcp_fastopen, c_options.defer_accept) == (4096, 256, 5)
+    assert (c_options.busy_poll, c_options.recv_buffer, c_options.send_buffer) == (50, 65536, 131072)
+    assert c_options.tcp_nodelay == -1
+
+
+@pytest.mark.parametrize("nodelay,expected", [(None, 0), (True, 1), (False, -1)])
+def test_tcp_nodelay_is_tri_state(nodelay, expected):
+    app = App()
+    app._is_cffi = True
+    mock_ffi = MagicMock()
+
+    with patch("xyra.application.lib", MagicMock()), patch("xyra.application.ffi", mock_ffi):
+        app.set_socket_options(tcp_nodelay=nodelay)
+
+    assert mock_ffi.new.return_value.tcp_nodelay == expected
+
+
+def test_set_socket_options_rejects_negative_values():
+    with pytest.raises(ValueError):
+        App().set_socket_options(backlog=-1)
+
+
+def test_set_socket_options_without_native_extension_warns():
+    app = App()
+    app._is_cffi = False
+
+    with patch("xyra.application.get_logger") as mock_get_logger:
+        app.set_socket_options(backlog=128)
+
+    mock_get_logger.return_value.warning.assert_called_once()
@@ -0,0 +1,118 @@
+import json
+import sys
+import time
+from unittest.mock import MagicMock, Mock, patch
+
+import pytest
+
+from xyra import App
+from xyra.__main__ import main
+from xyra.supervisor import Supervisor
+
+SLEEPER = [sys.executable, "-c", "import time; time.sleep(30)"]
+
+
+@pytest.fixture
+def supervisor(tmp_path):
+    sup = Supervisor(SLEEPER, 2, graceful_timeout=1, health_file=str(tmp_path / "health.json"))
+    yield sup
+    sup.stop()
+
+
+def test_supervisor_starts_workers_and_reports_health(supervisor, tmp_path):
+    supervisor.check()
+
+    status = supervisor.status()
+    assert status["healthy"] is True
+    assert status["workers_alive"] == 2
+    assert len({w["pid"] for w in status["workers"]}) == 2
+    assert json.loads((tmp_path / "health.json").read_text())["workers_total"] == 2
+
+
+def test_supervisor_replaces_exited_worker(supervisor):
+    supervisor.check()
+    worker = supervisor.workers[0]
+    old_pid = worker.proc.pid
+    worker.started_at -= 60  # ran long enough to not count as a crash
+    worker.proc.kill()
+    worker.proc.wait()
+
+    assert supervisor.status()["healthy"] is False
+    supervisor.check()
+
+    assert worker.alive
+    assert worker.proc.pid != old_pid
+    assert worker.restarts == 1
+
+
+def test_supervisor_backs_off_crashing_worker():
+    sup = Supervisor([sys.executable, "-c", "raise SystemExit(3)"], 1, graceful_timeout=1)
+    try:
+        sup.check()
+        sup.workers[0].proc.wait()
+        sup.check()
+
+        worker = sup.workers[0]
+        assert worker.proc is None
+        assert worker.crashes == 1
+        assert worker.next_start > time.monotonic()
+    finally:
+        sup.stop()
+
+
+def test_supervisor_stop_terminates_workers(supervisor):
+    supervisor.check()
+    procs = [w.proc for w in supervisor.workers]
+
+    supervisor.stop()
+    assert all(proc.poll() is not None for proc in procs)
+
+
+def test_supervisor_rejects_zero_workers():
+    with pytest.raises(ValueError):
+        Supervisor(SLEEPER, 0)
+
+
+@patch("xyra.__main__.ensure_port_free")
+@patch("xyra.__main__.Supervisor")
+@patch("argparse.ArgumentParser.parse_args")
+def test_main_workers_runs_supervisor(mock_parse_args, mock_supervisor, mock_port_free, monkeypatch):
+    monkeypatch.delenv("XYRA_WORKER_ID", raising=False)
+    mock_parse_args.return_value = Mock(
+        file="main.py", host="0.0.0.0", port=8000, reload=False, uds=None,
+        reload_signal=False, workers=4, max_requests=0,
+        ssl_certfile=None, ssl_keyfile=None, ssl_keyfile_password=None, health_file=None,
+    )
+
+    main()
+
+    mock_port_free.assert_called_once_with("0.0.0.0", 8000)
+    assert mock_supervisor.call_args[0][1] == 4
+    mock_supervisor.return_value.run.assert_called_once_with()
+
+
+def test_set_max_requests_configures_native_app():
+    app = App()
+    app._is_cffi = True
+    mock_lib = MagicMock()
+
+    with patch("xyra.application.lib", mock_lib):
+        assert app.set_max_requests(1000, drain_timeout=5) is app
+
+    mock_lib.xyra_app_set_max_requests.assert_called_once_with(app._app, 1000, 5000)
+
+
+def test_supervisor_rolling_restart_replaces_each_worker(supervisor):
+    import threading
+
+    supervisor.check()
+    old_pids = [w.proc.pid for w in supervisor.workers]
+
+    restart = threading.Thread(target=supervisor.rolling_restart)
+    restart.start()
+    while restart.is_alive():
+        supervisor.check()
+        time.sleep(0.05)
+
+    assert all(w.alive for w in supervisor.workers)
+    assert all(w.proc.pid not in old_pids for w in supervisor.workers)
@@ -0,0 +1,112 @@
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra import App
+
+
+def native_mocks():
+    mock_lib = MagicMock()
+    mock_lib.xyra_app_create_sibling.side_effect = lambda parent: object()
+    mock_ffi = MagicMock()
+    mock_ffi.callback = lambda signature: (lambda func: func)
+    return mock_lib, mock_ffi
+
+
+def native_app():
+    app = App()
+    app._is_cffi = True
+    app._app = object()
+    return app
+
+
+def test_thread_app_owns_native_app_loop_and_callbacks():
+    app = native_app()
+    app.get("/", lambda req, res: None)
+    mock_lib, mock_ffi = native_mocks()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        app._register_routes()
+        sibling = app._create_thread_app()
+
+    mock_lib.xyra_app_create_sibling.assert_called_once_with(app._app)
+    assert sibling._app is not app._app
+    assert sibling._loop is not app._loop
+    assert sibling._cffi_callbacks and not set(map(id, sibling._cffi_callbacks)) & set(
+        map(id, app._cffi_callbacks)
+    )
+    # Routes and middleware are shared, not copied
+    assert sibling.router is app.router
+    assert sibling.middlewares is app.middlewares
+
+
+def test_thread_apps_pool_their_own_request_objects():
+    app = native_app()
+    seen = []
+
+    def handler(req, res):
+        seen.append((req, res))
+        res._ended = True
+
+    app.get("/", handler)
+    mock_lib, mock_ffi = native_mocks()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        app._register_routes()
+        app._create_thread_app()
+
+    route_cbs = [call.args[2] for call in mock_lib.xyra_app_get.call_args_list]
+    assert len(route_cbs) == 2
+    for cb in route_cbs:
+        cb(object(), object(), None)
+
+    (req_a, res_a), (req_b, res_b) = seen
+    assert req_a is not req_b
+    assert res_a is not res_b
+
+
+def test_thread_app_replays_websocket_routes():
+    app = native_app()
+    mock_lib, mock_ffi = native_mocks()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        app.websocket("/ws", {"message": lambda ws, msg, opcode: None})
+        sibling = app._create_thread_app()
+
+    first, second = mock_lib.xyra_app_ws.call_args_list
+    assert first.args[0] is app._app
+    assert second.args[0] is sibling._app
+    assert second.args[1] == first.args[1] == b"/ws"
+
+
+def test_shutdown_reaches_every_event_loop():
+    app = native_app()
+    mock_lib, mock_ffi = native_mocks()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        app._thread_apps.append(app._create_thread_app())
+        app.shutdown(1.5)
+
+    targets = [call.args for call in mock_lib.xyra_app_shutdown.call_args_list]
+    assert targets == [(app._app, 1500), (app._thread_apps[0]._app, 1500)]
+
+
+def test_loop_threads_fail_when_sibling_tls_setup_fails():
+    app = native_app()
+    mock_lib, mock_ffi = native_mocks()
+    mock_lib.xyra_app_create_sibling.side_effect = lambda parent: mock_ffi.NULL
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        with pytest.raises(RuntimeError, match="TLS"):
+            app._start_loop_threads(2, "127.0.0.1", 8443, 1.0)
+
+    assert app._thread_apps == []
+    mock_lib.xyra_app_listen_host.assert_not_called()
+
+
+@pytest.mark.parametrize(
+    "kwargs", [{"threads": 0}, {"threads": 2, "unix_socket": "/tmp/xyra-threads.sock"}]
+)
+def test_run_server_rejects_invalid_threads(kwargs):
+    with pytest.raises(ValueError):
+        App().run_server(**kwargs)
@@ -0,0 +1,126 @@
+import types
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra import App
+
+
+def tls_mocks(available=True):
+    mock_lib = MagicMock()
+    mock_lib.xyra_tls_available.return_value = available
+    mock_lib.xyra_app_set_tls.return_value = True
+    mock_ffi = MagicMock()
+    mock_ffi.NULL = None
+    # Structs become plain namespaces; buffers are their initializers
+    mock_ffi.new.side_effect = lambda ctype, init=None: (
+        types.SimpleNamespace(ticket_keys=None, ticket_keys_len=0) if ctype.endswith("_t*") else init
+    )
+    return mock_lib, mock_ffi
+
+
+def native_app():
+    app = App()
+    app._is_cffi = True
+    return app
+
+
+def test_enable_tls_configures_native_app():
+    app = native_app()
+    mock_lib, mock_ffi = tls_mocks()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        assert app.enable_tls(
+            "cert.pem", "key.pem", password="secret", ciphers="ECDHE+AESGCM",
+            session_timeout=600, ticket_keys=b"k" * 80,
+        ) is app
+
+    (native_app_arg, c_options), _ = mock_lib.xyra_app_set_tls.call_args
+    assert native_app_arg is app._app
+    assert (c_options.cert_file, c_options.key_file, c_options.passphrase) == (
+        b"cert.pem", b"key.pem", b"secret"
+    )
+    assert (c_options.ca_file, c_options.ciphers) == (None, b"ECDHE+AESGCM")
+    assert (c_options.session_cache_size, c_options.session_timeout) == (20480, 600)
+    assert c_options.session_tickets is True
+    assert (c_options.ticket_keys, c_options.ticket_keys_len) == (b"k" * 80, 80)
+    assert app._tls
+
+
+def test_enable_tls_requires_tls_build():
+    app = native_app()
+    mock_lib, mock_ffi = tls_mocks(available=False)
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        with pytest.raises(RuntimeError, match="XYRA_TLS=1"):
+            app.enable_tls("cert.pem", "key.pem")
+
+    mock_lib.xyra_app_set_tls.assert_not_called()
+
+
+def test_enable_tls_reports_unloadable_certificate():
+    app = native_app()
+    mock_lib, mock_ffi = tls_mocks()
+    mock_lib.xyra_app_set_tls.return_value = False
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        with pytest.raises(ValueError, match="cert.pem"):
+            app.enable_tls("cert.pem", "key.pem")
+
+    assert not app._tls
+
+
+def test_add_server_name_needs_default_certificate():
+    app = native_app()
+    mock_lib, mock_ffi = tls_mocks()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        with pytest.raises(RuntimeError, match="enable_tls"):
+            app.add_server_name("api.example.com", "api.pem", "api.key")
+        app.enable_tls("cert.pem", "key.pem")
+        app.add_server_name("*.example.com", "wild.pem", "wild.key")
+
+    mock_lib.xyra_app_add_server_name.assert_called_once_with(
+        app._app, b"*.example.com", b"wild.pem", b"wild.key", None
+    )
+
+
+def test_add_server_name_reports_unloadable_certificate():
+    app = native_app()
+    mock_lib, mock_ffi = tls_mocks()
+    mock_lib.xyra_app_add_server_name.return_value = False
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        app.enable_tls("cert.pem", "key.pem")
+        with pytest.raises(ValueError, match="api.pem"):
+            app.add_server_name("api.example.com", "api.pem", "other.key")
+
+
+def test_run_server_refuses_plain_http_in_tls_build():
+    app = native_app()
+    mock_lib, mock_ffi = tls_mocks()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        with pytest.raises(RuntimeError, match="HTTPS only"):
+            app.run_server(8443)
+        with pytest.raises(ValueError, match="together"):
+            app.run_server(8443, ssl_certfile="cert.pem")
+
+    mock_lib.xyra_app_listen.assert_not_called()
+
+
+def test_socket_options_are_applied_in_tls_build():
+    app = native_app()
+    mock_lib, mock_ffi = tls_mocks()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        app.run_server(
+            8443, ssl_certfile="cert.pem", ssl_keyfile="key.pem", graceful_timeout=None,
+            socket_options={"tcp_nodelay": True, "backlog": 1024},
+        )
+
+    (native_app_arg, c_options), _ = mock_lib.xyra_app_set_socket_options.call_args
+    assert native_app_arg is app._app
+    assert (c_options.tcp_nodelay, c_options.backlog) == (1, 1024)
+    mock_lib.xyra_app_set_tls.assert_called_once()
+    mock_lib.xyra_app_listen_host.assert_called_once()
@@ -0,0 +1,156 @@
+import asyncio
+import threading
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra import App
+from xyra.websockets import AsyncDispatcher, DeferredWebSocket, WebSocket
+
+
+def run_dispatcher(handlers, events):
+    """Feed events to an AsyncDispatcher and wait for the handlers to finish."""
+    loop = asyncio.new_event_loop()
+    thread = threading.Thread(target=loop.run_forever, daemon=True)
+    thread.start()
+    try:
+        dispatcher = AsyncDispatcher(handlers, lambda: loop, lambda ws: ws, lambda ws, key: WebSocket(ws))
+        for event, *args in events:
+            getattr(dispatcher, event)(*args)
+
+        async def settle():
+            while len(asyncio.all_tasks()) > 1:
+                await asyncio.sleep(0.01)
+
+        asyncio.run_coroutine_threadsafe(settle(), loop).result(timeout=5)
+    finally:
+        loop.call_soon_threadsafe(loop.stop)
+        thread.join(timeout=5)
+        loop.close()
+
+
+def test_async_handlers_run_in_order_per_socket():
+    seen = []
+
+    async def on_open(ws):
+        await asyncio.sleep(0.05)
+        seen.append(("open", ws._ws))
+
+    async def on_message(ws, message, opcode):
+        await asyncio.sleep(0.01)
+        seen.append(("message", ws._ws, message))
+
+    def on_close(ws, code, message):
+        seen.append(("close", ws._ws, code))
+
+    a, b = object(), object()
+    run_dispatcher(
+        {"open": on_open, "message": on_message, "close": on_close},
+        [
+            ("open", a),
+            ("message", a, "1", 1),
+            ("open", b),
+            ("message", a, "2", 1),
+            ("close", a, 1000, b""),
+        ],
+    )
+
+    assert [e for e in seen if e[1] is a] == [
+        ("open", a),
+        ("message", a, "1"),
+        ("message", a, "2"),
+        ("close", a, 1000),
+    ]
+    assert ("open", b) in seen
+
+
+def test_async_handler_errors_do_not_stop_later_events():
+    seen = []
+
+    async def on_message(ws, message, opcode):
+        if message == "boom":
+            raise RuntimeError("boom")
+        seen.append(message)
+
+    ws = object()
+    run_dispatcher(
+        {"message": on_message},
+        [("open", ws), ("message", ws, "boom", 1), ("message", ws, "ok", 1)],
+    )
+    assert seen == ["ok"]
+
+
+def test_deferred_websocket_marshals_operations():
+    mock_lib = MagicMock()
+    app_ptr = object()
+    ws = DeferredWebSocket(app_ptr, 7)
+
+    with patch("xyra.websockets.lib", mock_lib):
+        ws.send("hi")
+        ws.publish("room", b"\x01", is_binary=True)
+        ws.subscribe("room")
+        ws.close()
+
+    calls = [c.args for c in mock_lib.xyra_ws_defer.call_args_list]
+    assert calls[0] == (app_ptr, 7, 0, b"", 0, b"hi", 2, 1, False)
+    assert calls[1] == (app_ptr, 7, 1, b"room", 4, b"\x01", 1, 2, False)
+    assert calls[2][2:5] == (3, b"room", 4)
+    assert calls[3][2] == 2
+    assert not ws.closed
+
+
+def test_native_async_route_uses_deferred_handles():
+    app = App()
+    app._is_cffi = True
+    app._app = object()
+    mock_lib = MagicMock()
+    mock_lib.xyra_ws_get_id.return_value = 42
+    mock_ffi = MagicMock()
+    mock_ffi.callback = lambda signature: (lambda func: func)
+    opened = asyncio.Event()
+    handles = []
+
+    async def on_open(ws):
+        handles.append(ws)
+        opened.set()
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        app.websocket("/ws", {"open": on_open})
+        open_cb = mock_lib.xyra_app_ws.call_args[0][2]
+        open_cb(object(), None)
+
+        async def wait_opened():
+            await opened.wait()
+
+        asyncio.run_coroutine_threadsafe(wait_opened(), app._get_loop()).result(timeout=5)
+
+    assert isinstance(handles[0], DeferredWebSocket)
+    assert handles[0].id == 42
+    assert handles[0]._app_ptr is app._app
+
+
+def test_async_route_without_close_handler_forgets_closed_sockets():
+    async def on_message(ws, message, opcode):
+        pass
+
+    app = App()
+    app._app = MagicMock()
+    app.websocket("/ws", {"message": on_message})
+    ws_config = app._app.ws.call_args[0][1]
+    dispatcher = ws_config["open"].__self__
+
+    ws = object()
+    ws_config["open"](ws)
+    assert ws in dispatcher._sockets
+    ws_config["close"](ws, 1000, b"")
+    assert dispatcher._sockets == {}
+
+
+@pytest.mark.parametrize("event", ["upgrade", "message_batch"])
+def test_async_upgrade_and_batch_handlers_rejected(event):
+    async def handler(*args):
+        return True
+
+    app = App()
+    with pytest.raises(ValueError):
+        app.websocket("/ws", {event: handler})
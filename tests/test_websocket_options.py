@@ -0,0 +1,220 @@
+from types import SimpleNamespace
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from xyra import App
+from xyra.websockets import WS_DEFAULT_OPTIONS, resolve_ws_options
+
+
+def test_resolve_ws_options_defaults():
+    assert resolve_ws_options(None) == WS_DEFAULT_OPTIONS
+
+
+def test_resolve_ws_options_combines_compression_names():
+    options = resolve_ws_options(
+        {"compression": ("dedicated_compressor_4kb", "shared_decompressor")}
+    )
+    assert options["compression"] == 146 | 256
+    assert resolve_ws_options({"compression": "shared"})["compression"] == 257
+    assert resolve_ws_options({"compression": 3840})["compression"] == 3840
+
+
+@pytest.mark.parametrize(
+    "options",
+    [
+        {"compresion": "shared"},
+        {"compression": "zstd"},
+        {"compression": ("dedicated_compressor_3kb", "dedicated_compressor_4kb")},
+        {"compression": ("shared_compressor", "dedicated_compressor")},
+        {"compression": ("shared", "dedicated_decompressor_4kb")},
+        {"compression": 145 | 146},
+        {"compression": 0x10000},
+        {"idle_timeout": 5},
+        {"max_backpressure": -1},
+        {"max_lifetime": 241},
+    ],
+)
+def test_resolve_ws_options_rejects_invalid(options):
+    with pytest.raises(ValueError):
+        resolve_ws_options(options)
+
+
+def test_websocket_options_rejected_at_registration():
+    app = App()
+    with pytest.raises(ValueError):
+        app.websocket("/ws", {"open": lambda ws: None}, options={"idle_timeout": 1})
+
+
+def test_websocket_options_passed_to_native_app():
+    app = App()
+    app._is_cffi = True
+    app._app = object()
+    mock_lib = MagicMock()
+    mock_ffi = MagicMock()
+    c_options = MagicMock()
+    mock_ffi.new.return_value = c_options
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        app.websocket(
+            "/feed",
+            {"message": lambda ws, msg, opcode: None},
+            options={"compression": "shared", "idle_timeout": 30, "max_backpressure": 1024},
+        )
+
+    mock_ffi.new.assert_called_once_with("xyra_ws_options_t*")
+    assert c_options.compression == 257
+    assert c_options.idle_timeout == 30
+    assert c_options.max_backpressure == 1024
+    assert c_options.max_payload_length == 16 * 1024
+    assert c_options.send_pings_automatically is True
+    args = mock_lib.xyra_app_ws.call_args[0]
+    assert args[1] == b"/feed"
+    assert args[9] is c_options
+
+
+def test_websocket_batch_handler_receives_wrapped_sockets():
+    app = App()
+    app._app = MagicMock()
+    received = []
+
+    app.websocket("/ws", {"message_batch": received.extend})
+
+    ws_config = app._app.ws.call_args[0][1]
+    raw = MagicMock()
+    ws_config["message_batch"]([(raw, "a", 1), (raw, b"b", 2)])
+
+    assert [(ws._ws, msg, opcode) for ws, msg, opcode in received] == [
+        (raw, "a", 1),
+        (raw, b"b", 2),
+    ]
+
+
+def test_websocket_batch_limits_loop_over_message_handler():
+    app = App()
+    app._app = MagicMock()
+    received = []
+
+    app.websocket(
+        "/ws",
+        {"message": lambda ws, msg, opcode: received.append(msg)},
+        options={"batch_max_messages": 64},
+    )
+
+    ws_config = app._app.ws.call_args[0][1]
+    ws_config["message_batch"]([(MagicMock(), "a", 1), (MagicMock(), "b", 1)])
+    assert received == ["a", "b"]
+
+
+def test_websocket_batch_skips_sockets_closed_mid_batch():
+    app = App()
+    app._is_cffi = True
+    app._app = object()
+    closed = set()
+    mock_lib = MagicMock()
+    mock_lib.xyra_ws_close.side_effect = closed.add
+    mock_lib.xyra_ws_is_closed.side_effect = lambda ws: ws in closed
+    mock_ffi = MagicMock()
+    mock_ffi.callback = lambda signature: (lambda func: func)
+    mock_ffi.buffer = lambda ptr, length: ptr[:length]
+    received = []
+
+    def on_message(ws, message, opcode):
+        received.append((ws._ws, message))
+        if message == b"bye":
+            ws.close()
+
+    first, second = object(), object()
+    entries = [
+        SimpleNamespace(ws=first, message=b"bye", len=3, opcode=2),
+        SimpleNamespace(ws=second, message=b"hi", len=2, opcode=2),
+        SimpleNamespace(ws=first, message=b"late", len=4, opcode=2),
+    ]
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi), patch(
+        "xyra.websockets.lib", mock_lib
+    ):
+        app.websocket("/ws", {"message": on_message}, options={"batch_max_messages": 64})
+        batch_cb = mock_lib.xyra_app_ws.call_args[0][7]
+        batch_cb(entries, len(entries), None)
+
+    # The first socket's close handler ran inside the batch; its later
+    # message is dropped instead of delivered after the close
+    assert received == [(first, b"bye"), (second, b"hi")]
+
+
+def test_websocket_without_batching_has_no_batch_handler():
+    app = App()
+    app._app = MagicMock()
+
+    app.websocket("/ws", {"message": lambda ws, msg, opcode: None})
+
+    assert "message_batch" not in app._app.ws.call_args[0][1]
+
+
+def test_websocket_ping_pong_handlers_share_control_callback():
+    app = App()
+    app._is_cffi = True
+    app._app = object()
+    mock_lib = MagicMock()
+    mock_ffi = MagicMock()
+    mock_ffi.callback = lambda signature: (lambda func: func)
+    mock_ffi.buffer = lambda ptr, length: ptr[:length]
+    seen = []
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        app.websocket(
+            "/ws",
+            {
+                "ping": lambda ws, message: seen.append(("ping", message)),
+                "pong": lambda ws, message: seen.append(("pong", ws._ws, message)),
+            },
+        )
+        control_cb = mock_lib.xyra_app_ws.call_args[0][8]
+        control_cb("ws", b"hb", 2, 10, None)
+        control_cb("ws", b"x", 1, 9, None)
+
+    assert seen == [("pong", "ws", b"hb"), ("ping", b"x")]
+
+
+def test_websocket_count_reads_native_app():
+    app = App()
+    app._is_cffi = True
+    mock_lib = MagicMock()
+    mock_lib.xyra_app_ws_count.return_value = 3
+
+    with patch("xyra.application.lib", mock_lib):
+        assert app.websocket_count() == 3
+    mock_lib.xyra_app_ws_count.assert_called_once_with(app._app)
+
+
+def test_websocket_large_messages_spool_to_file():
+    import cffi
+
+    real_ffi = cffi.FFI()
+    app = App()
+    app._is_cffi = True
+    app._app = object()
+    mock_lib = MagicMock()
+    mock_ffi = MagicMock()
+    mock_ffi.callback = lambda signature: (lambda func: func)
+    mock_ffi.buffer = real_ffi.buffer
+    received = []
+
+    with patch("xyra.application.lib", mock_lib), patch("xyra.application.ffi", mock_ffi):
+        app.websocket(
+            "/upload",
+            {"message": lambda ws, message, opcode: received.append(message)},
+            options={"spool_threshold": 4},
+        )
+        args = mock_lib.xyra_app_ws.call_args[0]
+        msg_cb = args[3]
+        small, large = real_ffi.new("char[]", b"abc"), real_ffi.new("char[]", b"abcdefgh")
+        msg_cb("ws", small, 3, 2, None)
+        msg_cb("ws", large, 8, 2, None)
+
+    # Python-only options never reach the native struct
+    assert "max_lifetime" in vars(args[9])
+    assert "spool_threshold" not in vars(args[9])
+    assert received[0] == b"abc"
+    assert received[1].read() == b"abcdefgh"
+    received[1].close()
@@ -1,9 +1,9 @@
-from unittest.mock import Mock
+from unittest.mock import MagicMock, Mock
 
 import pytest
 
 # from socketify import OpCode
-from xyra.websockets import WebSocket
+from xyra.websockets import PreparedMessage, SendStatus, WebSocket
 
 
 from unittest.mock import patch
@@ -17,7 +17,7 @@ def mock_fallback_ws():
 @pytest.fixture
 def mock_socketify_ws():
     ws = Mock()
-    ws.send = Mock()
+    ws.send = Mock(return_value=SendStatus.SUCCESS)
     ws.publish = Mock()
     ws.subscribe = Mock()
     ws.unsubscribe = Mock()
@@ -37,6 +37,12 @@ def test_websocket_send_text(mock_socketify_ws):
     mock_socketify_ws.send.assert_called_once_with("Hello", False)
 
 
+def test_websocket_send_rejects_unknown_status(mock_socketify_ws):
+    mock_socketify_ws.send.return_value = None
+    with pytest.raises(ValueError):
+        WebSocket(mock_socketify_ws).send("Hello")
+
+
 def test_websocket_send_text_method(mock_socketify_ws):
     ws = WebSocket(mock_socketify_ws)
     ws.send_text("Hello")
@@ -163,6 +169,7 @@ def test_websocket_message_handling():
 
 @patch("xyra.websockets.lib")
 def test_websocket_fallback_send_str(mock_lib, mock_fallback_ws):
+    mock_lib.xyra_ws_send.return_value = 1
     ws = WebSocket(mock_fallback_ws)
     ws.send("Hello", False)
 
@@ -171,6 +178,7 @@ def test_websocket_fallback_send_str(mock_lib, mock_fallback_ws):
 
 @patch("xyra.websockets.lib")
 def test_websocket_fallback_send_bytes(mock_lib, mock_fallback_ws):
+    mock_lib.xyra_ws_send.return_value = 1
     ws = WebSocket(mock_fallback_ws)
     ws.send_binary(b"binary data")
 
@@ -234,3 +242,217 @@ def test_websocket_fallback_closed_exception(mock_lib, mock_ffi, mock_fallback_w
     # Exception during the check means it's considered closed
     mock_ffi.new.side_effect = Exception("Test Exception")
     assert ws.closed is True
+
+
+@patch("xyra.websockets.lib")
+def test_websocket_fallback_send_returns_status(mock_lib, mock_fallback_ws):
+    ws = WebSocket(mock_fallback_ws)
+
+    mock_lib.xyra_ws_send.return_value = 0
+    assert ws.send("Hello") is SendStatus.BACKPRESSURE
+    mock_lib.xyra_ws_send.return_value = 2
+    assert ws.send_binary(b"x") is SendStatus.DROPPED
+
+
+@patch("xyra.websockets.lib")
+def test_websocket_fallback_buffered_amount(mock_lib, mock_fallback_ws):
+    ws = WebSocket(mock_fallback_ws)
+    mock_lib.xyra_ws_get_buffered_amount.return_value = 4096
+
+    assert ws.buffered_amount == 4096
+    mock_lib.xyra_ws_get_buffered_amount.assert_called_once_with(mock_fallback_ws)
+
+
+def test_websocket_drain_handler_registered():
+    from xyra import App
+
+    drained = []
+    app = App()
+    app.websocket("/feed", {"drain": lambda ws: drained.append(ws)})
+
+    ws_config = app._app.ws.call_args[0][1]
+    ws_config["drain"]("native_ws")
+    assert isinstance(drained[0], WebSocket)
+    assert drained[0]._ws == "native_ws"
+
+
+def test_websocket_send_prepared_falls_back_to_send(mock_socketify_ws):
+    ws = WebSocket(mock_socketify_ws)
+    prepared = PreparedMessage("tick", is_binary=False)
+
+    ws.send_prepared(prepared)
+    mock_socketify_ws.send.assert_called_once_with("tick", False)
+
+
+def test_websocket_send_prepared_native(mock_fallback_ws):
+    mock_lib = MagicMock()
+    mock_lib.xyra_ws_send_prepared.return_value = 1
+    with patch("xyra.websockets.lib", mock_lib), patch("xyra.websockets.ffi", MagicMock()):
+        prepared = PreparedMessage(b"\x01\x02", is_binary=True)
+        ws = WebSocket(mock_fallback_ws)
+        assert ws.send_prepared(prepared) is SendStatus.SUCCESS
+
+    mock_lib.xyra_prepared_message_create.assert_called_once_with(b"\x01\x02", 2, 2, False)
+    mock_lib.xyra_ws_send_prepared.assert_called_once_with(mock_fallback_ws, prepared._native)
+
+
+def test_websocket_state_is_shared_across_wrappers(mock_socketify_ws):
+    WebSocket(mock_socketify_ws).state["user"] = "alice"
+    assert WebSocket(mock_socketify_ws).state == {"user": "alice"}
+
+
+def test_websocket_state_lives_in_native_slot():
+    import cffi
+
+    from xyra import websockets
+
+    real_ffi = cffi.FFI()
+    slot = {"ptr": real_ffi.NULL}
+    mock_lib = MagicMock()
+    mock_lib.xyra_ws_get_user_data.side_effect = lambda ws: slot["ptr"]
+    mock_lib.xyra_ws_set_user_data.side_effect = lambda ws, ptr: slot.update(ptr=ptr)
+    mock_lib.xyra_ws_retain.side_effect = lambda ws: real_ffi.cast("void *", 1)
+    native_ws = object()
+
+    with patch("xyra.websockets.lib", mock_lib), patch("xyra.websockets.ffi", real_ffi):
+        WebSocket(native_ws).state["n"] = 1
+        assert WebSocket(native_ws).state == {"n": 1}
+        assert len(websockets._state_handles) == 1
+
+        websockets.release_state(native_ws)
+
+    assert slot["ptr"] == real_ffi.NULL
+    assert websockets._state_handles == {}
+
+
+def test_native_websocket_holds_a_handle_reference():
+    import gc
+
+    import cffi
+
+    real_ffi = cffi.FFI()
+    handle = real_ffi.new("char[1]")
+    mock_lib = MagicMock()
+    mock_lib.xyra_ws_retain.side_effect = lambda ws: real_ffi.cast("void *", ws)
+
+    with patch("xyra.websockets.lib", mock_lib), patch("xyra.websockets.ffi", real_ffi):
+        ws = WebSocket(handle)
+        mock_lib.xyra_ws_retain.assert_called_once_with(handle)
+        mock_lib.xyra_ws_release.assert_not_called()
+        del ws
+        gc.collect()
+
+    mock_lib.xyra_ws_release.assert_called_once()
+
+
+def test_websocket_state_after_close_is_not_stored():
+    import cffi
+
+    from xyra import websockets
+
+    real_ffi = cffi.FFI()
+    mock_lib = MagicMock()
+    mock_lib.xyra_ws_retain.side_effect = lambda ws: real_ffi.cast("void *", 1)
+    mock_lib.xyra_ws_get_user_data.return_value = real_ffi.NULL
+    mock_lib.xyra_ws_get_remote_address_bytes.return_value = 0
+
+    with patch("xyra.websockets.lib", mock_lib), patch("xyra.websockets.ffi", real_ffi):
+        assert WebSocket(object()).state == {}
+
+    mock_lib.xyra_ws_set_user_data.assert_not_called()
+    assert websockets._state_handles == {}
+
+
+def test_websocket_ping_native(mock_fallback_ws):
+    mock_lib = MagicMock()
+    mock_lib.xyra_ws_ping.return_value = 1
+    mock_lib.xyra_ws_get_idle_ms.return_value = 2500
+    with patch("xyra.websockets.lib", mock_lib):
+        ws = WebSocket(mock_fallback_ws)
+        assert ws.ping("hb") is SendStatus.SUCCESS
+        assert ws.idle_time == 2.5
+
+    mock_lib.xyra_ws_ping.assert_called_once_with(mock_fallback_ws, b"hb", 2)
+
+
+def test_websocket_ping_uses_wrapped_socket_ping():
+    wrapped = Mock(spec=["send", "ping"])
+    wrapped.ping.return_value = 1
+
+    assert WebSocket(wrapped).ping("hb") is SendStatus.SUCCESS
+
+    wrapped.ping.assert_called_once_with(b"hb")
+    wrapped.send.assert_not_called()
+
+
+def test_websocket_ping_refuses_socket_without_ping():
+    wrapped = Mock(spec=["send"])
+
+    with pytest.raises(RuntimeError, match="native extension"):
+        WebSocket(wrapped).ping()
+
+    wrapped.send.assert_not_called()
+
+
+def test_websocket_send_fragments_native(mock_fallback_ws):
+    mock_lib = MagicMock()
+    mock_lib.xyra_ws_send_fragment.return_value = 1
+    with patch("xyra.websockets.lib", mock_lib):
+        ws = WebSocket(mock_fallback_ws)
+        assert ws.send_fragments(iter([b"a", "b", b"c"])) is SendStatus.SUCCESS
+        ws.send_fragments([], is_binary=False)
+
+    calls = [c.args[1:] for c in mock_lib.xyra_ws_send_fragment.call_args_list]
+    assert calls == [
+        (b"a", 1, True, True, False),
+        (b"b", 1, True, False, False),
+        (b"c", 1, True, False, True),
+        (b"", 0, False, True, True),
+    ]
+
+
+def test_websocket_send_fragments_ends_socket_when_chunks_raise(mock_fallback_ws):
+    def chunks():
+        yield b"a"
+        yield b"b"
+        raise RuntimeError("producer failed")
+
+    mock_lib = MagicMock()
+    mock_lib.xyra_ws_send_fragment.return_value = 1
+    with patch("xyra.websockets.lib", mock_lib):
+        with pytest.raises(RuntimeError, match="producer failed"):
+            WebSocket(mock_fallback_ws).send_fragments(chunks())
+
+    # Only b"a" went out as the first frame; the message can never be finished
+    assert [c.args[1] for c in mock_lib.xyra_ws_send_fragment.call_args_list] == [b"a"]
+    mock_lib.xyra_ws_end.assert_called_once_with(mock_fallback_ws, 1011, b"", 0)
+
+
+def test_websocket_send_fragments_stops_after_dropped_frame(mock_fallback_ws):
+    mock_lib = MagicMock()
+    mock_lib.xyra_ws_send_fragment.side_effect = [1, 2]
+    with patch("xyra.websockets.lib", mock_lib):
+        status = WebSocket(mock_fallback_ws).send_fragments([b"a", b"b", b"c", b"d"])
+
+    assert status is SendStatus.DROPPED
+    assert mock_lib.xyra_ws_send_fragment.call_count == 2
+    mock_lib.xyra_ws_end.assert_called_once_with(mock_fallback_ws, 1011, b"", 0)
+
+
+def test_websocket_send_fragments_raising_before_start_leaves_socket_open(mock_fallback_ws):
+    def chunks():
+        raise RuntimeError("nothing to send")
+        yield b""
+
+    mock_lib = MagicMock()
+    with patch("xyra.websockets.lib", mock_lib):
+        with pytest.raises(RuntimeError):
+            WebSocket(mock_fallback_ws).send_fragments(chunks())
+
+    mock_lib.xyra_ws_send_fragment.assert_not_called()
+    mock_lib.xyra_ws_end.assert_not_called()
+
+
+def test_websocket_send_fragments_falls_back_to_send(mock_socketify_ws):
+    WebSocket(mock_socketify_ws).send_fragments([b"a", b"b"])
+    mock_socketify_ws.send.assert_called_once_with(b"ab", True)
@@ -7,8 +7,18 @@ try:
     from .routing import Router
 except ImportError:
     pass
-from .websockets import WebSocket
+from .websockets import PreparedMessage, PubSubBus, SendStatus, WebSocket
 
 __version__ = "0.2.6"
 
-__all__ = ["App", "Request", "Response", "WebSocket", "Router", "HTTPException"]
+__all__ = [
+    "App",
+    "Request",
+    "Response",
+    "WebSocket",
+    "SendStatus",
+    "PubSubBus",
+    "PreparedMessage",
+    "Router",
+    "HTTPException",
+]
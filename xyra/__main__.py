@@ -1,8 +1,13 @@
 import argparse
 import importlib.util
 import os
+import random
 import sys
 
+from .application import ensure_port_free
+from .logger import setup_logging
+from .supervisor import Supervisor, is_worker, worker_command
+
 
 def load_app_from_file(file_path: str):
     """
@@ -56,6 +61,24 @@ def load_app_from_file(file_path: str):
         sys.exit(1)
 
 
+def run_supervisor(args) -> None:
+    """Run --workers N: a supervisor process that starts and restarts the workers."""
+    if args.uds:
+        print("Error: --workers cannot be combined with --uds.")
+        sys.exit(1)
+    if args.reload or args.reload_signal:
+        print("Error: --workers cannot be combined with --reload; send SIGHUP to the supervisor instead.")
+        sys.exit(1)
+    try:
+        ensure_port_free(args.host, args.port)
+    except RuntimeError as e:
+        print(f"Error starting server: {e}")
+        sys.exit(1)
+
+    setup_logging()
+    Supervisor(worker_command(), args.workers, health_file=args.health_file).run()
+
+
 def main():
     """
     Main entry point for the Xyra CLI.
@@ -76,22 +99,100 @@ def main():
     parser.add_argument(
         "--port", type=int, default=8000, help="Port to listen on (default: 8000)."
     )
+    parser.add_argument(
+        "--uds",
+        default=None,
+        help="Listen on this Unix domain socket path instead of host/port.",
+    )
     parser.add_argument(
         "--reload",
         action="store_true",
         help="Enable auto-reload on file changes (development mode).",
     )
+    parser.add_argument(
+        "--reload-signal",
+        action="store_true",
+        help="Run under a supervisor that restarts the server on SIGHUP without "
+        "dropping connections (no file watching).",
+    )
+
+    parser.add_argument(
+        "--workers",
+        type=int,
+        default=1,
+        help="Number of worker processes sharing the port (default: 1).",
+    )
+    parser.add_argument(
+        "--threads",
+        type=int,
+        default=1,
+        help="Event loops per process, one per thread (default: 1). Scales "
+        "across cores on free-threaded Python (3.13t+).",
+    )
+    parser.add_argument(
+        "--ssl-certfile",
+        default=None,
+        help="Serve HTTPS with this PEM certificate chain (needs a build with XYRA_TLS=1).",
+    )
+    parser.add_argument(
+        "--ssl-keyfile", default=None, help="PEM private key for --ssl-certfile."
+    )
+    parser.add_argument(
+        "--ssl-keyfile-password",
+        default=None,
+        help="Passphrase of an encrypted --ssl-keyfile.",
+    )
+    parser.add_argument(
+        "--max-requests",
+        type=int,
+        default=0,
+        help="Recycle a worker after this many requests (default: 0, never).",
+    )
+    parser.add_argument(
+        "--max-requests-jitter",
+        type=int,
+        default=0,
+        help="Add up to this many requests to --max-requests per worker, so "
+        "workers do not recycle at the same time.",
+    )
+    parser.add_argument(
+        "--health-file",
+        default=None,
+        help="With --workers, keep a JSON health summary of the workers at this path.",
+    )
 
     args = parser.parse_args()
 
+    if args.workers > 1 and not is_worker():
+        run_supervisor(args)
+        return
+
     # Load the application from the specified file
     app = load_app_from_file(args.file)
 
     # Note: Auto-reload is handled internally by app.listen()
 
+    if args.max_requests:
+        app.set_max_requests(
+            args.max_requests + random.randint(0, max(0, args.max_requests_jitter))  # nosec B311
+        )
+
     try:
         # Start the server with the specified configuration
-        app.listen(port=args.port, host=args.host, reload=args.reload)
+        reload = {"reload": args.reload}
+        if args.reload_signal:
+            reload = {"reload": True, "reload_watch": False}
+        tls = {}
+        if args.ssl_certfile or args.ssl_keyfile:
+            tls = {
+                "ssl_certfile": args.ssl_certfile,
+                "ssl_keyfile": args.ssl_keyfile,
+                "ssl_keyfile_password": args.ssl_keyfile_password,
+            }
+        if args.uds:
+            app.listen(unix_socket=args.uds, threads=args.threads, **reload, **tls)
+        else:
+            app.listen(port=args.port, host=args.host, threads=args.threads, **reload, **tls)
     except KeyboardInterrupt:
         print("\n👋 Server stopped.")
     except Exception as e:
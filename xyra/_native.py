@@ -0,0 +1,21 @@
+# Native extension loader.
+#
+# uSockets picks its event backend at link time, so builds with
+# XYRA_IO_URING=1 ship two extensions: _libxyra_uring (io_uring) and
+# _libxyra (epoll). The io_uring one is used when the running kernel accepts
+# io_uring_setup; old kernels and seccomp profiles that refuse it (common in
+# containers) get the epoll one. Setting XYRA_EVENT_BACKEND=epoll skips the
+# io_uring extension.
+import os
+
+try:
+    if os.environ.get("XYRA_EVENT_BACKEND") == "epoll":
+        raise ImportError("io_uring disabled by XYRA_EVENT_BACKEND")
+    from ._libxyra_uring import ffi, lib
+
+    if not lib.xyra_event_backend_usable():
+        raise ImportError("io_uring is not usable on this kernel")
+except ImportError:
+    from ._libxyra import ffi, lib
+
+__all__ = ["ffi", "lib"]
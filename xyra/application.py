@@ -4,7 +4,10 @@ import json
 import mimetypes
 import os
 import re
+import signal
 import socket
+import sys
+import tempfile
 import threading
 import time
 import traceback
@@ -16,7 +19,7 @@ from urllib.parse import unquote
 # if the extension isn't fully compiled yet.
 try:
 
-    from ._libxyra import ffi, lib
+    from ._native import ffi, lib
 except ImportError:
     lib = None
     ffi = None
@@ -27,7 +30,15 @@ from .response import MAX_BODY_SIZE, Response
 from .routing import Router
 from .swagger import generate_swagger
 from .templating import Templating
-from .websockets import WebSocket
+from .websockets import (
+    WS_PYTHON_OPTIONS,
+    AsyncDispatcher,
+    DeferredWebSocket,
+    PubSubBus,
+    WebSocket,
+    release_state,
+    resolve_ws_options,
+)
 
 # SECURITY: Pre-compile regex for dotfile validation in static files
 # Blocks access to hidden files/directories (dotfiles), except .well-known
@@ -35,6 +46,102 @@ DOTFILE_RE = re.compile(
     rf"(^|{re.escape(os.sep)})\.(?!well-known({re.escape(os.sep)}|$))"
 )
 
+# How long a reload replacement may take to start listening
+_RELOAD_READY_TIMEOUT = 30.0
+
+
+def _notify_ready() -> None:
+    """Tell a reloading parent that this server is listening (see run_server)."""
+    ready_fd = os.environ.pop("XYRA_READY_FD", None)
+    if ready_fd:
+        try:
+            os.write(int(ready_fd), b"1")
+            os.close(int(ready_fd))
+        except OSError:
+            pass
+
+
+def _wait_for_ready(fd: int, proc, timeout: float) -> bool:
+    """Wait for a reload replacement's readiness byte; False if it exits or times out."""
+    import select
+
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        readable, _, _ = select.select([fd], [], [], 0.5)
+        if readable:
+            return os.read(fd, 1) == b"1"
+        if proc.poll() is not None:
+            return False
+    return False
+
+
+def ensure_port_free(host: str, port: int) -> None:
+    """Raise RuntimeError if host:port is already bound by another server."""
+    family = socket.AF_INET
+    try:
+        family = socket.getaddrinfo(host or None, port, type=socket.SOCK_STREAM)[0][0]
+    except OSError:
+        pass
+    sock = socket.socket(family, socket.SOCK_STREAM)
+    try:
+        sock.bind((host, port))
+    except OSError as e:
+        raise RuntimeError(
+            f"Port {port} is already in use. Only one instance of Xyra can run per port."
+        ) from e
+    finally:
+        sock.close()
+
+
+def tls_available() -> bool:
+    """True if the native extension was built with TLS (XYRA_TLS=1)."""
+    return getattr(lib, "xyra_tls_available", None) is not None and lib.xyra_tls_available() is True
+
+
+def _bind_listener(host: str, port: int, unix_socket: str | None) -> socket.socket:
+    """Bind the listening socket a reloading parent passes to every server."""
+    if unix_socket:
+        _prepare_unix_socket(unix_socket)
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        sock.bind(unix_socket)
+        sock.listen(socket.SOMAXCONN)
+        return sock
+    if not host:
+        if socket.has_dualstack_ipv6():
+            return socket.create_server(
+                ("", port), family=socket.AF_INET6, backlog=socket.SOMAXCONN, dualstack_ipv6=True
+            )
+        return socket.create_server(("", port), backlog=socket.SOMAXCONN)
+    family = socket.getaddrinfo(host, port, type=socket.SOCK_STREAM)[0][0]
+    return socket.create_server((host, port), family=family, backlog=socket.SOMAXCONN)
+
+
+def _inherited_listen_fd() -> int | None:
+    """The listening socket passed down by a reloading parent, if any."""
+    listen_fd = os.environ.pop("XYRA_LISTEN_FD", None)
+    if listen_fd is None or getattr(lib, "xyra_app_listen_fd", None) is None:
+        return None
+    return int(listen_fd)
+
+
+def _prepare_unix_socket(path: str) -> None:
+    """Remove a stale socket file left by a previous run, refusing live ones."""
+    if not os.path.exists(path):
+        return
+    import stat
+
+    if not stat.S_ISSOCK(os.stat(path).st_mode):
+        raise RuntimeError(f"{path} exists and is not a socket.")
+    probe = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        probe.connect(path)
+    except OSError:
+        os.unlink(path)
+        return
+    finally:
+        probe.close()
+    raise RuntimeError(f"{path} is already in use by a running server.")
+
 
 class App:
     """
@@ -89,9 +196,17 @@ class App:
         self._swagger_cache: dict[str, Any] | None = None
         self._swagger_lock = threading.Lock()
         self.log_requests = True  # Will be set in run_server
+        self._shutdown_timeout: float | None = None  # Set by shutdown()
+        self._ws_routes: list[tuple] = []  # Replayed onto per-thread apps
+        self._thread_apps: list[App] = []  # Extra event loops (run_server threads)
+        self._tls = False  # Set by enable_tls
 
     def route(
-        self, method: str, path: str, handler: Callable | None = None
+        self,
+        method: str,
+        path: str,
+        handler: Callable | None = None,
+        max_body_size: int | None = None,
     ) -> Union[Callable, "App"]:
         """
         Register a route with the specified HTTP method.
@@ -102,6 +217,9 @@ class App:
             method: HTTP method (GET, POST, etc.).
             path: URL path pattern (supports parameters like {id}).
             handler: Request handler function (optional if used as decorator).
+            max_body_size: Largest Content-Length accepted for this route
+                and method, overriding enable_request_limits; 0 lifts the
+                limit (native extension only).
 
         Returns:
             If handler is None, returns a decorator function.
@@ -119,13 +237,13 @@ class App:
         if handler is None:
             # Used as decorator
             def decorator(func):
-                self._router.add_route(method.upper(), path, func)
+                self._router.add_route(method.upper(), path, func, max_body_size)
                 return func
 
             return decorator
         else:
             # Used as method call
-            self._router.add_route(method.upper(), path, handler)
+            self._router.add_route(method.upper(), path, handler, max_body_size)
             return self
 
     @overload
@@ -138,21 +256,29 @@ class App:
         """Register a GET route."""
         return self.route("GET", path, handler)
 
-    def post(self, path: str, handler: Callable | None = None):
+    def post(
+        self, path: str, handler: Callable | None = None, max_body_size: int | None = None
+    ):
         """Register a POST route."""
-        return self.route("POST", path, handler)
+        return self.route("POST", path, handler, max_body_size)
 
-    def put(self, path: str, handler: Callable | None = None):
+    def put(
+        self, path: str, handler: Callable | None = None, max_body_size: int | None = None
+    ):
         """Register a PUT route."""
-        return self.route("PUT", path, handler)
+        return self.route("PUT", path, handler, max_body_size)
 
-    def delete(self, path: str, handler: Callable | None = None):
+    def delete(
+        self, path: str, handler: Callable | None = None, max_body_size: int | None = None
+    ):
         """Register a DELETE route."""
-        return self.route("DELETE", path, handler)
+        return self.route("DELETE", path, handler, max_body_size)
 
-    def patch(self, path: str, handler: Callable | None = None):
+    def patch(
+        self, path: str, handler: Callable | None = None, max_body_size: int | None = None
+    ):
         """Register a PATCH route."""
-        return self.route("PATCH", path, handler)
+        return self.route("PATCH", path, handler, max_body_size)
 
     def head(self, path: str, handler: Callable | None = None):
         """Register a HEAD route."""
@@ -168,13 +294,23 @@ class App:
         return self
 
     @overload
-    def websocket(self, path: str) -> Callable[[Callable], "App"]: ...
+    def websocket(
+        self, path: str, *, options: dict[str, Any] | None = None
+    ) -> Callable[[Callable], "App"]: ...
 
     @overload
-    def websocket(self, path: str, handlers: dict[str, Callable]) -> "App": ...
+    def websocket(
+        self,
+        path: str,
+        handlers: dict[str, Callable],
+        options: dict[str, Any] | None = None,
+    ) -> "App": ...
 
     def websocket(
-        self, path: str, handlers: dict[str, Callable] | None = None
+        self,
+        path: str,
+        handlers: dict[str, Callable] | None = None,
+        options: dict[str, Any] | None = None,
     ) -> Union[Callable, "App"]:
         """
         Register a WebSocket route.
@@ -183,7 +319,20 @@ class App:
 
         Args:
             path: WebSocket path pattern.
-            handlers: Dictionary with event handlers ('open', 'message', 'close', etc.).
+            handlers: Dictionary with event handlers ('open', 'message', 'close',
+                'drain', 'ping', 'pong', 'upgrade', 'message_batch'). open,
+                message, close, drain, ping and pong may be async; the
+                route's handlers then run on the
+                asyncio loop, in order per socket, with a handle whose
+                operations are queued back to the event loop.
+            options: Behaviour overrides: compression, max_payload_length,
+                idle_timeout, max_backpressure, close_on_backpressure_limit,
+                reset_idle_timeout_on_send, send_pings_automatically,
+                max_lifetime, batch_max_messages, batch_max_bytes,
+                spool_threshold. Idle sockets are pinged and then closed
+                natively after idle_timeout seconds without traffic. Messages
+                over spool_threshold bytes reach the message handler as a
+                binary temporary file (the handler owns and closes it).
 
         Returns:
             If handlers is None, returns a decorator function.
@@ -200,38 +349,115 @@ class App:
                 "open": on_open,
                 "message": on_message,
                 "close": on_close
-            })
+            }, options={"compression": "shared", "idle_timeout": 30})
         """
+        # Validate eagerly so bad options fail at registration time
+        resolved_options = resolve_ws_options(options)
+
         if handlers is None:
             # Used as decorator
             def decorator(func):
-                self._register_websocket(path, {"open": func})
+                self._register_websocket(path, {"open": func}, resolved_options)
                 return func
 
             return decorator
         else:
             # Used as method call
-            self._register_websocket(path, handlers)
+            self._register_websocket(path, handlers, resolved_options)
             return self
 
-    def _register_websocket(self, path: str, handlers: dict[str, Callable]):
+    def _register_websocket(
+        self,
+        path: str,
+        handlers: dict[str, Callable],
+        options: dict[str, Any] | None = None,
+    ):
         """Register WebSocket route with native App."""
+        self._ws_routes.append((path, handlers, options))
         # Map Xyra event handlers to native callbacks
         ws_config = {}
 
-        # Map event handlers
-        if "open" in handlers:
-            ws_config["open"] = lambda ws: handlers["open"](WebSocket(ws))
+        is_async = any(
+            inspect.iscoroutinefunction(handlers.get(event))
+            for event in ("open", "message", "close", "drain", "ping", "pong")
+        )
+        if inspect.iscoroutinefunction(handlers.get("message_batch")):
+            raise ValueError("message_batch handler must be synchronous")
+        if inspect.iscoroutinefunction(handlers.get("upgrade")):
+            raise ValueError("upgrade handler must be synchronous")
+
+        if is_async:
+            # Handlers run on the asyncio loop. Natively they get a deferred
+            # handle addressed by connection id: no socket pointer leaves the
+            # uWS thread, and operations on closed sockets are dropped there.
+            if self._is_cffi and not hasattr(self._app, '_mock_name'):
+                app_ptr = self._app
+                dispatcher = AsyncDispatcher(
+                    handlers,
+                    self._get_loop,
+                    lib.xyra_ws_get_id,
+                    lambda ws, conn_id: DeferredWebSocket(app_ptr, conn_id),
+                )
+            else:
+                dispatcher = AsyncDispatcher(
+                    handlers, self._get_loop, lambda ws: ws, lambda ws, key: WebSocket(ws, self)
+                )
+            ws_config["open"] = dispatcher.open
+            # Always wired: it drops the dispatcher's per-socket entry, and
+            # only dispatches to a close handler if the route has one.
+            ws_config["close"] = dispatcher.close
+            if "message" in handlers:
+                ws_config["message"] = dispatcher.message
+            if "drain" in handlers:
+                ws_config["drain"] = dispatcher.drain
+            if "ping" in handlers:
+                ws_config["ping"] = dispatcher.ping
+            if "pong" in handlers:
+                ws_config["pong"] = dispatcher.pong
+        elif "open" in handlers:
+            ws_config["open"] = lambda ws: handlers["open"](WebSocket(ws, self))
+
+        if not is_async:
+            if "message" in handlers:
+                ws_config["message"] = lambda ws, message, opcode: handlers["message"](
+                    WebSocket(ws, self), message, opcode
+                )
 
-        if "message" in handlers:
-            ws_config["message"] = lambda ws, message, opcode: handlers["message"](
-                WebSocket(ws), message, opcode
-            )
+            if "close" in handlers:
+                ws_config["close"] = lambda ws, code, message: handlers["close"](
+                    WebSocket(ws, self), code, message
+                )
 
-        if "close" in handlers:
-            ws_config["close"] = lambda ws, code, message: handlers["close"](
-                WebSocket(ws), code, message
+            if "drain" in handlers:
+                ws_config["drain"] = lambda ws: handlers["drain"](WebSocket(ws, self))
+
+            if "ping" in handlers:
+                ws_config["ping"] = lambda ws, message: handlers["ping"](WebSocket(ws, self), message)
+
+            if "pong" in handlers:
+                ws_config["pong"] = lambda ws, message: handlers["pong"](WebSocket(ws, self), message)
+
+        # Batched delivery: one call per event loop iteration with a list of
+        # (ws, message, opcode), or the per-message handler run in a loop.
+        options = options or resolve_ws_options(None)
+        if "message_batch" in handlers:
+            ws_config["message_batch"] = lambda batch: handlers["message_batch"](
+                [(WebSocket(ws, self), message, opcode) for ws, message, opcode in batch]
             )
+        elif "message" in handlers and (
+            options["batch_max_messages"] or options["batch_max_bytes"]
+        ):
+            native_ws = self._is_cffi and not hasattr(self._app, "_mock_name")
+
+            def _deliver_batch(batch):
+                for ws, message, opcode in batch:
+                    # A handler earlier in the batch closed the socket, and its
+                    # close handler has run: the rest is not delivered.
+                    if native_ws and lib.xyra_ws_is_closed(ws):
+                        continue
+                    ws_config["message"](ws, message, opcode)
+
+            ws_config["message_batch"] = _deliver_batch
 
         if "upgrade" in handlers:
             ws_config["upgrade"] = handlers["upgrade"]
@@ -276,6 +502,20 @@ class App:
         if self._is_cffi:
             # We need to adapt the handlers to CFFI callbacks
 
+            spool_threshold = options["spool_threshold"]
+
+            def read_message(msg_ptr, msg_len, opcode):
+                if spool_threshold and msg_len > spool_threshold:
+                    # Straight from the native buffer: no bytes copy in Python
+                    spool = tempfile.TemporaryFile()
+                    spool.write(ffi.buffer(msg_ptr, msg_len))
+                    spool.seek(0)
+                    return spool
+                msg = ffi.buffer(msg_ptr, msg_len)[:]
+                if opcode == 1: # TEXT
+                    msg = msg.decode('utf-8')
+                return msg
+
             @ffi.callback("void(xyra_websocket_t*, void*)")
             def _open_cb(ws_ptr, user_data):
                 if "open" in ws_config:
@@ -285,10 +525,7 @@ class App:
             @ffi.callback("void(xyra_websocket_t*, const char*, size_t, int, void*)")
             def _msg_cb(ws_ptr, msg_ptr, msg_len, opcode, user_data):
                 if "message" in ws_config:
-                    msg = ffi.buffer(msg_ptr, msg_len)[:]
-                    if opcode == 1: # TEXT
-                        msg = msg.decode('utf-8')
-                    ws_config["message"](ws_ptr, msg, opcode)
+                    ws_config["message"](ws_ptr, read_message(msg_ptr, msg_len, opcode), opcode)
             self._cffi_callbacks.append(_msg_cb)
 
             @ffi.callback("bool(xyra_response_t*, xyra_request_t*, void*)")
@@ -302,20 +539,116 @@ class App:
 
             @ffi.callback("void(xyra_websocket_t*, int, const char*, size_t, void*)")
             def _close_cb(ws_ptr, code, msg_ptr, msg_len, user_data):
-                if "close" in ws_config:
-                    msg = ffi.buffer(msg_ptr, msg_len)[:] if msg_ptr else b""
-                    ws_config["close"](ws_ptr, code, msg)
+                try:
+                    if "close" in ws_config:
+                        msg = ffi.buffer(msg_ptr, msg_len)[:] if msg_ptr else b""
+                        ws_config["close"](ws_ptr, code, msg)
+                finally:
+                    release_state(ws_ptr)
             self._cffi_callbacks.append(_close_cb)
 
+            _batch_cb = ffi.NULL
+            if "message_batch" in ws_config:
+                @ffi.callback("void(const xyra_ws_batch_entry_t*, size_t, void*)")
+                def _batch_cb(entries, count, user_data):
+                    batch = []
+                    for i in range(count):
+                        entry = entries[i]
+                        msg = read_message(entry.message, entry.len, entry.opcode)
+                        batch.append((entry.ws, msg, entry.opcode))
+                    ws_config["message_batch"](batch)
+                self._cffi_callbacks.append(_batch_cb)
+
+            _drain_cb = ffi.NULL
+            if "drain" in ws_config:
+                @ffi.callback("void(xyra_websocket_t*, void*)")
+                def _drain_cb(ws_ptr, user_data):
+                    ws_config["drain"](ws_ptr)
+                self._cffi_callbacks.append(_drain_cb)
+
+            _control_cb = ffi.NULL
+            if "ping" in ws_config or "pong" in ws_config:
+                @ffi.callback("void(xyra_websocket_t*, const char*, size_t, int, void*)")
+                def _control_cb(ws_ptr, msg_ptr, msg_len, opcode, user_data):
+                    handler = ws_config.get("ping" if opcode == 9 else "pong")
+                    if handler is not None:
+                        handler(ws_ptr, ffi.buffer(msg_ptr, msg_len)[:])
+                self._cffi_callbacks.append(_control_cb)
+
             path_b = path.encode('utf-8')
 
             # Support mock objects in tests which pass an object instead of cdata
             if hasattr(self._app, '_mock_name'):
-                self._app.ws(path, ws_config)
+                self._app.ws(path, ws_config, options)
             else:
-                lib.xyra_app_ws(self._app, path_b, _open_cb, _msg_cb, _upgrade_cb, _close_cb, ffi.NULL)
+                c_options = ffi.new("xyra_ws_options_t*")
+                for key, value in options.items():
+                    if key not in WS_PYTHON_OPTIONS:
+                        setattr(c_options, key, value)
+                lib.xyra_app_ws(
+                    self._app, path_b, _open_cb, _msg_cb, _upgrade_cb, _close_cb,
+                    _drain_cb, _batch_cb, _control_cb, c_options, ffi.NULL,
+                )
         else:
-            self._app.ws(path, ws_config)
+            self._app.ws(path, ws_config, options)
+
+    def websocket_count(self) -> int:
+        """Number of open WebSocket connections (0 without the native core)."""
+        if self._is_cffi and getattr(lib, "xyra_app_ws_count", None) is not None:
+            return lib.xyra_app_ws_count(self._app)
+        return 0
+
+    def publish(
+        self,
+        topic: str,
+        message: str | bytes,
+        is_binary: bool = False,
+        compress: bool = False,
+    ):
+        """
+        Publish a message to every WebSocket subscribed to topic.
+
+        Unlike WebSocket.publish this needs no connection handle, and it may
+        be called from any thread (HTTP handlers, background tasks): off the
+        event loop thread the message is queued and sent on the next loop
+        iteration.
+
+        Args:
+            topic: Topic name.
+            message: Text or binary payload.
+            is_binary: Send as a binary frame instead of text.
+            compress: Compress the message if the route enables compression.
+        """
+        pubsub = getattr(self, "_pubsub", None)
+        if pubsub is not None and pubsub._native is None:
+            pubsub.publish(topic, message, is_binary, compress)
+            return self
+
+        if hasattr(self._app, "_mock_name") or not self._is_cffi:
+            self._app.publish(topic, message, is_binary, compress)
+            return self
+
+        c_topic = topic.encode("utf-8")
+        c_msg = message.encode("utf-8") if isinstance(message, str) else message
+        lib.xyra_app_publish(
+            self._app, c_topic, len(c_topic), c_msg, len(c_msg), 2 if is_binary else 1, compress
+        )
+        return self
+
+    def join_pubsub(self, bus: PubSubBus):
+        """
+        Join a cross-loop pub/sub bus.
+
+        Afterwards App.publish (and bus.publish from any thread) reaches
+        subscribers on every App that joined the same bus. Join before the
+        server starts.
+        """
+        self._pubsub = bus
+        if bus._native is not None and self._is_cffi and not hasattr(self._app, "_mock_name"):
+            lib.xyra_app_join_pubsub(self._app, bus._native)
+        elif self not in bus._apps:
+            bus._apps.append(self)
+        return self
 
     def static_files(self, path: str, directory: str):
         """Serve static files from a directory."""
@@ -577,8 +910,8 @@ class App:
 
         return async_final_handler
 
-    def _register_routes(self):
-        """Register all routes with the underlying native app."""
+    def _get_loop(self) -> asyncio.AbstractEventLoop:
+        """The asyncio loop async handlers run on, started on first use."""
         if not hasattr(self, "_loop"):
             self._loop = asyncio.new_event_loop()
 
@@ -586,9 +919,103 @@ class App:
                 asyncio.set_event_loop(loop)
                 loop.run_forever()
 
-            import threading
-
             threading.Thread(target=run_loop, args=(self._loop,), daemon=True).start()
+        return self._loop
+
+    def _create_thread_app(self) -> "App":
+        """
+        A copy of this App on the calling thread's own event loop.
+
+        Routes, middleware and templates are shared and only read while
+        serving. The native app, asyncio loop, pooled Request/Response
+        objects and callbacks belong to the copy, so nothing mutable is
+        shared between loops on the dispatch path.
+        """
+        app = App.__new__(App)
+        app.__dict__.update(self.__dict__)
+        app.__dict__.pop("_loop", None)
+        app._app = lib.xyra_app_create_sibling(self._app)
+        if app._app == ffi.NULL:
+            raise RuntimeError("Could not set up TLS for another event loop")
+        app._cffi_callbacks = []
+        app._ws_routes = []
+        app._thread_apps = []
+        for path, handlers, options in self._ws_routes:
+            app._register_websocket(path, handlers, options)
+        app._register_routes()
+        return app
+
+    def _start_loop_threads(
+        self, count: int, host: str, port: int, timeout: float, listen_fd: int | None = None
+    ) -> list[threading.Thread]:
+        """
+        Serve from count more event loops, one per thread, all bound to
+        host:port with SO_REUSEPORT so the kernel spreads connections (or
+        all accepting from listen_fd).
+
+        This scales across cores on a free-threaded interpreter; with the
+        GIL the loops still take turns running Python handlers.
+        """
+        logger = get_logger("xyra")
+        if getattr(lib, "xyra_app_create_sibling", None) is None:
+            logger.warning("Multiple event loops require the native extension; using one.")
+            return []
+        if getattr(sys, "_is_gil_enabled", lambda: True)():
+            logger.warning(
+                f"The GIL is enabled: handlers on the {count + 1} event loops will not run in parallel."
+            )
+
+        if getattr(self, "_pubsub", None) is None and self._ws_routes:
+            # uWS pub/sub only reaches the publishing loop
+            self.join_pubsub(PubSubBus())
+
+        failures = []
+
+        def serve(index: int, created: threading.Event):
+            try:
+                app = self._create_thread_app()
+            except RuntimeError as e:
+                failures.append(e)
+                created.set()
+                return
+            self._thread_apps.append(app)
+            created.set()
+
+            @ffi.callback("void(bool, void*)")
+            def _listen_cb(success, user_data):
+                if not success:
+                    logger.error(f"Event loop {index} failed to listen on port {port}")
+            app._cffi_callbacks.append(_listen_cb)
+            if listen_fd is not None:
+                lib.xyra_app_listen_fd(app._app, listen_fd, _listen_cb, ffi.NULL)
+            else:
+                lib.xyra_app_listen_host(app._app, host.encode(), port, 0, _listen_cb, ffi.NULL)
+            lib.xyra_app_run(app._app)
+
+            # One loop stopping (max_requests, failed listen) stops them all
+            self.shutdown(self._shutdown_timeout if self._shutdown_timeout is not None else timeout)
+            app._drain_async_tasks(self._shutdown_timeout or 0.0)
+
+        threads = []
+        for index in range(1, count + 1):
+            created = threading.Event()
+            thread = threading.Thread(
+                target=serve, args=(index, created), daemon=True, name=f"xyra-loop-{index}"
+            )
+            thread.start()
+            # Every loop is known before any can trigger a shutdown
+            created.wait()
+            if failures:
+                self.shutdown(0.0)
+                for started in threads:
+                    started.join()
+                raise failures[0]
+            threads.append(thread)
+        return threads
+
+    def _register_routes(self):
+        """Register all routes with the underlying native app."""
+        self._get_loop()
 
         def create_wrap_async():
             def wrap_async(handler):
@@ -672,8 +1099,13 @@ class App:
                 if hasattr(self._app, '_mock_name'):
                     getattr(self._app, method)(parsed_path, _route_cb)
                 elif hasattr(lib, c_method_name):
+                    c_options = ffi.NULL
+                    if route.get("max_body_size") is not None:
+                        c_options = ffi.new("xyra_route_options_t*")
+                        c_options.has_max_body_size = True
+                        c_options.max_body_size = route["max_body_size"]
                     c_method = getattr(lib, c_method_name)
-                    c_method(self._app, parsed_path.encode('utf-8'), _route_cb, ffi.NULL)
+                    c_method(self._app, parsed_path.encode('utf-8'), _route_cb, ffi.NULL, c_options)
             else:
                 if hasattr(self._app, method):
                     getattr(self._app, method)(parsed_path, cb_wrapper)
@@ -698,7 +1130,7 @@ class App:
             if hasattr(self._app, '_mock_name'):
                 self._app.any("/*", _any_cb)
             else:
-                lib.xyra_app_any(self._app, b"/*", _any_cb, ffi.NULL)
+                lib.xyra_app_any(self._app, b"/*", _any_cb, ffi.NULL, ffi.NULL)
         else:
             self._app.any("/*", wrap_async(final_handler))
 
@@ -720,6 +1152,325 @@ class App:
 
         self.use(SecurityHeadersMiddleware(**kwargs))
 
+    def enable_rate_limit(
+        self, requests: int = 100, window: int = 60, max_entries: int = 10000
+    ):
+        """
+        Enable the native per-IP rate limiter.
+
+        Requests over the limit are answered with 429 and Retry-After from the
+        native layer, before any Python object is created. Clients are keyed by
+        their peer address (IPv6 aggregated to /64), so behind a proxy use
+        RateLimitMiddleware together with ProxyHeadersMiddleware instead.
+
+        Args:
+            requests: Maximum requests allowed per window.
+            window: Window length in seconds.
+            max_entries: Approximate number of client addresses tracked.
+        """
+        if requests < 1 or window < 1:
+            raise ValueError("requests and window must be positive")
+
+        if self._is_cffi and getattr(lib, "xyra_app_set_rate_limit", None) is not None:
+            lib.xyra_app_set_rate_limit(self._app, requests, window, max_entries)
+        else:
+            from .middleware.rate_limiter import rate_limiter
+
+            self.use(
+                rate_limiter(requests=requests, window=window, max_entries=max_entries)
+            )
+        return self
+
+    def enable_request_limits(
+        self,
+        max_headers: int = 100,
+        max_header_bytes: int = 16 * 1024,
+        max_url_length: int = 8 * 1024,
+        max_query_fields: int = 1000,
+        max_body_size: int = MAX_BODY_SIZE,
+    ):
+        """
+        Enforce request size limits in the native layer.
+
+        Oversized requests are answered 414 (URL or query fields), 431
+        (header count or bytes) or 413 (declared Content-Length) and the
+        connection is closed, without any Python object being created.
+        Chunked bodies carry no Content-Length and are still capped while
+        being read. Pass 0 to disable an individual limit; routes may
+        override max_body_size when they are registered.
+
+        Args:
+            max_headers: Maximum number of request headers.
+            max_header_bytes: Maximum total size of the request headers.
+            max_url_length: Maximum length of the URL including the query.
+            max_query_fields: Maximum number of query string fields.
+            max_body_size: Maximum Content-Length in bytes.
+        """
+        limits = (max_headers, max_header_bytes, max_url_length, max_query_fields, max_body_size)
+        if any(limit < 0 for limit in limits):
+            raise ValueError("request limits must not be negative")
+
+        if self._is_cffi and getattr(lib, "xyra_app_set_request_limits", None) is not None:
+            c_limits = ffi.new("xyra_request_limits_t*")
+            c_limits.max_headers = max_headers
+            c_limits.max_header_bytes = max_header_bytes
+            c_limits.max_url_length = max_url_length
+            c_limits.max_query_fields = max_query_fields
+            c_limits.max_body_size = max_body_size
+            lib.xyra_app_set_request_limits(self._app, c_limits)
+        else:
+            get_logger("xyra").warning(
+                "Request limits require the native extension and are ignored."
+            )
+        return self
+
+    def set_max_requests(self, max_requests: int, drain_timeout: float = 30.0) -> "App":
+        """
+        Recycle this process after max_requests HTTP requests (0 = never).
+
+        The request that reaches the limit is still served; the server then
+        shuts down gracefully (see shutdown) so a supervisor such as
+        `xyra --workers N` can start a fresh worker, bounding the effect of
+        leaks in long-running processes.
+        """
+        if max_requests < 0 or drain_timeout < 0:
+            raise ValueError("max_requests and drain_timeout must not be negative")
+
+        if self._is_cffi and getattr(lib, "xyra_app_set_max_requests", None) is not None:
+            lib.xyra_app_set_max_requests(self._app, max_requests, int(drain_timeout * 1000))
+        else:
+            get_logger("xyra").warning(
+                "max_requests requires the native extension and is ignored."
+            )
+        return self
+
+    def set_socket_options(
+        self,
+        tcp_nodelay: bool | None = None,
+        tcp_fastopen: int = 0,
+        defer_accept: int = 0,
+        busy_poll: int = 0,
+        recv_buffer: int = 0,
+        send_buffer: int = 0,
+        backlog: int = 0,
+    ) -> "App":
+        """
+        Tune the listen and accepted sockets (native extension only).
+
+        Zero (or None) keeps the uSockets/OS default; call before the server
+        starts listening. Options the platform lacks are skipped.
+
+        Args:
+            tcp_nodelay: Disable Nagle on accepted sockets (uSockets already
+                does; pass False to re-enable batching).
+            tcp_fastopen: TCP_FASTOPEN queue length on the listen socket.
+            defer_accept: Seconds TCP_DEFER_ACCEPT waits for the first bytes
+                before waking the server for a new connection.
+            busy_poll: SO_BUSY_POLL microseconds on accepted sockets.
+            recv_buffer: SO_RCVBUF in bytes (inherited by accepted sockets).
+            send_buffer: SO_SNDBUF in bytes (inherited by accepted sockets).
+            backlog: Listen queue length (uSockets uses 512).
+        """
+        values = (tcp_fastopen, defer_accept, busy_poll, recv_buffer, send_buffer, backlog)
+        if any(value < 0 for value in values):
+            raise ValueError("socket options must not be negative")
+
+        if self._is_cffi and getattr(lib, "xyra_app_set_socket_options", None) is not None:
+            c_options = ffi.new("xyra_socket_options_t*")
+            c_options.backlog = backlog
+            c_options.tcp_fastopen = tcp_fastopen
+            c_options.defer_accept = defer_accept
+            c_options.busy_poll = busy_poll
+            c_options.recv_buffer = recv_buffer
+            c_options.send_buffer = send_buffer
+            c_options.tcp_nodelay = 0 if tcp_nodelay is None else (1 if tcp_nodelay else -1)
+            lib.xyra_app_set_socket_options(self._app, c_options)
+        else:
+            get_logger("xyra").warning(
+                "Socket options require the native extension and are ignored."
+            )
+        return self
+
+    def set_http_timeouts(
+        self,
+        idle_timeout: int = 0,
+        header_timeout: int = 0,
+        body_timeout: int = 0,
+        max_keepalive_requests: int = 0,
+    ) -> "App":
+        """
+        Bound how long connections may hold a socket (native extension only).
+
+        Enforced by uSockets timers, which tick every 4 seconds, so values
+        are rounded up to a multiple of 4; zero keeps the default. Timed out
+        connections are closed without a response.
+
+        Args:
+            idle_timeout: Seconds a keep-alive connection may wait for its
+                next request (default 10).
+            header_timeout: Seconds a new connection may take to send its
+                first request's headers (default 10); limits slowloris.
+                Later requests on a keep-alive connection are bounded by
+                idle_timeout instead, which covers the wait and the headers.
+            body_timeout: Seconds allowed between body chunks while a
+                handler reads the body (default unbounded).
+            max_keepalive_requests: Requests served on one connection before
+                it is closed (default unlimited).
+        """
+        timeouts = (idle_timeout, header_timeout, body_timeout)
+        if any(not 0 <= timeout <= 900 for timeout in timeouts):
+            raise ValueError("timeouts must be between 0 and 900 seconds")
+        if max_keepalive_requests < 0:
+            raise ValueError("max_keepalive_requests must not be negative")
+
+        if self._is_cffi and getattr(lib, "xyra_app_set_http_timeouts", None) is not None:
+            c_timeouts = ffi.new("xyra_http_timeouts_t*")
+            c_timeouts.idle_timeout = idle_timeout
+            c_timeouts.header_timeout = header_timeout
+            c_timeouts.body_timeout = body_timeout
+            c_timeouts.max_keepalive_requests = max_keepalive_requests
+            lib.xyra_app_set_http_timeouts(self._app, c_timeouts)
+        else:
+            get_logger("xyra").warning(
+                "HTTP timeouts require the native extension and are ignored."
+            )
+        return self
+
+    def enable_tls(
+        self,
+        certfile: str,
+        keyfile: str,
+        password: str | None = None,
+        ca_certs: str | None = None,
+        ciphers: str | None = None,
+        session_cache_size: int = 20480,
+        session_timeout: int = 0,
+        session_tickets: bool = True,
+        ticket_keys: bytes | None = None,
+    ) -> "App":
+        """
+        Terminate TLS in the native layer instead of behind a proxy.
+
+        Requires a build with XYRA_TLS=1 (see tls_available), which serves
+        HTTPS only. Call before the server starts listening.
+
+        Args:
+            certfile: PEM certificate chain.
+            keyfile: PEM private key.
+            password: Passphrase of an encrypted keyfile.
+            ca_certs: PEM CA bundle; when set, clients must present a
+                certificate it signed (mutual TLS).
+            ciphers: OpenSSL cipher list for TLS 1.2 and below.
+            session_cache_size: Sessions cached for resumption by id
+                (0 disables the cache).
+            session_timeout: Session lifetime in seconds (0 keeps OpenSSL's).
+            session_tickets: Allow resumption with session tickets.
+            ticket_keys: Ticket keys (80 bytes with OpenSSL) shared by every
+                worker behind the port, so tickets resume on any of them;
+                random per process when omitted.
+        """
+        if session_cache_size < 0 or session_timeout < 0:
+            raise ValueError("session_cache_size and session_timeout must not be negative")
+        if not self._is_cffi or not tls_available():
+            raise RuntimeError("TLS requires the native extension built with XYRA_TLS=1")
+
+        keep_alive = [
+            ffi.new("char[]", value.encode()) if value else ffi.NULL
+            for value in (certfile, keyfile, password, ca_certs, ciphers)
+        ]
+        c_options = ffi.new("xyra_tls_options_t*")
+        (
+            c_options.cert_file,
+            c_options.key_file,
+            c_options.passphrase,
+            c_options.ca_file,
+            c_options.ciphers,
+        ) = keep_alive
+        c_options.session_cache_size = session_cache_size
+        c_options.session_timeout = session_timeout
+        c_options.session_tickets = session_tickets
+        if ticket_keys is not None:
+            c_keys = ffi.new("unsigned char[]", ticket_keys)
+            keep_alive.append(c_keys)
+            c_options.ticket_keys = c_keys
+            c_options.ticket_keys_len = len(ticket_keys)
+
+        if not lib.xyra_app_set_tls(self._app, c_options):
+            raise ValueError(
+                f"Could not load TLS certificate {certfile!r} and key {keyfile!r}"
+            )
+        self._tls = True
+        return self
+
+    def add_server_name(
+        self, hostname: str, certfile: str, keyfile: str, password: str | None = None
+    ) -> "App":
+        """
+        Serve hostname (SNI; "*.example.com" allowed) with its own certificate.
+
+        Clients asking for other names get the enable_tls certificate, so
+        call enable_tls first.
+        """
+        if not self._tls:
+            raise RuntimeError("enable_tls must be called before add_server_name")
+        if not lib.xyra_app_add_server_name(
+            self._app,
+            hostname.encode(),
+            certfile.encode(),
+            keyfile.encode(),
+            password.encode() if password else ffi.NULL,
+        ):
+            raise ValueError(
+                f"Could not load TLS certificate {certfile!r} and key {keyfile!r} for {hostname!r}"
+            )
+        return self
+
+    def enable_connection_filter(
+        self,
+        deny: list[str] | None = None,
+        allow: list[str] | None = None,
+        max_connections_per_ip: int = 0,
+    ):
+        """
+        Filter connections as they are accepted, before any HTTP parsing.
+
+        Sockets whose peer address is denied (or outside the allow list), or
+        that exceed max_connections_per_ip concurrent connections from one
+        address, are closed straight away by the native layer. Only the peer
+        address is seen here, so behind a proxy use IPFilterMiddleware instead.
+        WebSockets count towards max_connections_per_ip until they close; the
+        cap holds across the event loops of run_server(threads=N), but each
+        --workers process counts on its own.
+
+        Args:
+            deny: IPs or CIDR networks whose connections are dropped.
+            allow: IPs or CIDR networks allowed to connect (None allows all).
+            max_connections_per_ip: Concurrent connection cap per address (0 disables).
+        """
+        from .datastructures import IPSet
+
+        # Parse eagerly so invalid entries raise ValueError in both modes
+        deny_set = IPSet(deny or [])
+        allow_set = IPSet(allow) if allow is not None else None
+
+        if self._is_cffi and getattr(lib, "xyra_app_set_connection_filter", None) is not None:
+            lib.xyra_app_set_connection_filter(
+                self._app,
+                deny_set._native if deny else ffi.NULL,
+                allow_set._native if allow_set is not None else ffi.NULL,
+                max_connections_per_ip,
+            )
+        else:
+            if deny or allow is not None:
+                from .middleware.ip_filter import IPFilterMiddleware
+
+                self.use(IPFilterMiddleware(allow=allow, deny=deny))
+            if max_connections_per_ip:
+                get_logger("xyra").warning(
+                    "max_connections_per_ip requires the native extension and is ignored."
+                )
+        return self
+
     def enable_swagger(self, host: str = "localhost", port: int = 8000):
         """
         Enable Swagger UI documentation for the API.
@@ -824,34 +1575,118 @@ class App:
         host: str = "localhost",
         reload: bool = False,
         log_enabled: bool = False,
+        unix_socket: str | None = None,
+        graceful_timeout: float | None = 30.0,
+        reload_watch: bool = True,
+        threads: int = 1,
+        socket_options: dict[str, Any] | None = None,
+        ssl_certfile: str | None = None,
+        ssl_keyfile: str | None = None,
+        ssl_keyfile_password: str | None = None,
     ):
-        """Start the server."""
+        """
+        Start the server.
+
+        Binds host:port (an IPv4/IPv6 address or name; "" for every
+        interface), or the Unix domain socket path unix_socket instead.
+        Unless graceful_timeout is None, SIGTERM triggers
+        shutdown(graceful_timeout) and this returns once drained.
+
+        With reload=True the server runs in a child process that is replaced
+        on file changes (unless reload_watch is False) and on SIGHUP. The
+        replacement starts listening before the old child drains, so no
+        connection is refused during a restart; where the native extension
+        supports it, this process binds the socket once and every child
+        accepts from it, so queued connections are not reset either.
+
+        threads > 1 runs that many event loops in this process, each on its
+        own thread with its own asyncio loop, sharing the port. Use it on a
+        free-threaded (3.13t+) interpreter; max_requests counts per loop.
+        socket_options are passed to set_socket_options, and ssl_certfile
+        (with ssl_keyfile_password) to enable_tls (for the other TLS settings
+        call enable_tls directly).
+        """
+        if threads < 1:
+            raise ValueError("threads must be at least 1")
+        if threads > 1 and unix_socket:
+            raise ValueError("threads cannot be combined with unix_socket")
+
         if reload and os.environ.get("XYRA_RELOAD_CHILD") != "1":
             try:
                 import subprocess  # nosec B404
                 import sys
                 import time
 
-                import watchfiles
+                if reload_watch:
+                    import watchfiles
 
             except ImportError:
                 print("watchfiles not installed, install with: pip install watchfiles")
                 return
 
-            print("🔄 Auto-reload enabled. Watching for file changes...")
+            if reload_watch:
+                print("🔄 Auto-reload enabled. Watching for file changes...")
+            if hasattr(signal, "SIGHUP"):
+                print(f"🔄 Send SIGHUP to {os.getpid()} to restart without dropping connections.")
 
             current_proc = None
+            restart_lock = threading.Lock()
+            # Needs fd passing for the readiness pipe; elsewhere the old
+            # server stops before the new one.
+            handoff = os.name == "posix"
+            # Every server accepts from the socket bound here, so connections
+            # waiting in its backlog survive a handoff. Without native support
+            # servers bind their own (SO_REUSEPORT, set by uSockets).
+            listener = None
+            if handoff and getattr(lib, "xyra_app_listen_fd", None) is not None:
+                listener = _bind_listener(host, port, unix_socket)
 
             def start_server():
+                # The new server starts listening beside the old one and
+                # reports over a pipe once it is; only then is the old one
+                # sent SIGTERM to drain, so a listener is up throughout.
                 nonlocal current_proc
-                if current_proc:
-                    current_proc.terminate()
-                    current_proc.wait()
-                env = os.environ.copy()
-                env["XYRA_RELOAD_CHILD"] = "1"
-                current_proc = subprocess.Popen(
-                    [sys.executable, "-E"] + sys.argv, env=env
-                )  # nosec B603
+                with restart_lock:
+                    old_proc = current_proc
+                    env = os.environ.copy()
+                    env["XYRA_RELOAD_CHILD"] = "1"
+                    if not handoff:
+                        if old_proc:
+                            old_proc.terminate()
+                            old_proc.wait()
+                        current_proc = subprocess.Popen(
+                            [sys.executable, "-E"] + sys.argv, env=env
+                        )  # nosec B603
+                        return
+
+                    ready_r, ready_w = os.pipe()
+                    env["XYRA_READY_FD"] = str(ready_w)
+                    pass_fds = (ready_w,)
+                    if listener is not None:
+                        env["XYRA_LISTEN_FD"] = str(listener.fileno())
+                        pass_fds += (listener.fileno(),)
+                    try:
+                        proc = subprocess.Popen(
+                            [sys.executable, "-E"] + sys.argv, env=env, pass_fds=pass_fds
+                        )  # nosec B603
+                    finally:
+                        os.close(ready_w)
+                    try:
+                        ready = old_proc is None or _wait_for_ready(
+                            ready_r, proc, _RELOAD_READY_TIMEOUT
+                        )
+                    finally:
+                        os.close(ready_r)
+                    if not ready:
+                        print("❌ New server did not start; keeping the running one.")
+                        proc.terminate()
+                        proc.wait()
+                        return
+
+                    current_proc = proc
+                    if old_proc:
+                        old_proc.terminate()  # graceful shutdown, see run_server
+                        threading.Thread(target=old_proc.wait, daemon=True).start()
 
             # Watch for file changes in current directory
             def watch_and_restart():
@@ -861,11 +1696,18 @@ class App:
                     print("🔄 Files changed, restarting server...")
                     start_server()
 
-            # Start watcher in background
-            import threading
+            if reload_watch:
+                # Start watcher in background
+                watcher_thread = threading.Thread(target=watch_and_restart, daemon=True)
+                watcher_thread.start()
+
+            previous_sighup = None
+            if hasattr(signal, "SIGHUP"):
+                def on_sighup(signum, frame):
+                    print("🔄 SIGHUP received, restarting server...")
+                    threading.Thread(target=start_server, daemon=True).start()
 
-            watcher_thread = threading.Thread(target=watch_and_restart, daemon=True)
-            watcher_thread.start()
+                previous_sighup = signal.signal(signal.SIGHUP, on_sighup)
 
             # Start initial server
             start_server()
@@ -878,11 +1720,28 @@ class App:
                 if current_proc:
                     current_proc.terminate()
                     current_proc.wait()
+            finally:
+                if previous_sighup is not None:
+                    signal.signal(signal.SIGHUP, previous_sighup)
+                if listener is not None:
+                    listener.close()
+                    if unix_socket and os.path.exists(unix_socket):
+                        os.unlink(unix_socket)
 
             return
 
         if self.swagger_options:
             self.enable_swagger(host, port)
+        if socket_options:
+            self.set_socket_options(**socket_options)
+        if ssl_certfile or ssl_keyfile:
+            if not (ssl_certfile and ssl_keyfile):
+                raise ValueError("ssl_certfile and ssl_keyfile must be given together")
+            self.enable_tls(ssl_certfile, ssl_keyfile, ssl_keyfile_password)
+        if not self._tls and self._is_cffi and tls_available():
+            raise RuntimeError(
+                "This build serves HTTPS only; pass ssl_certfile and ssl_keyfile or call enable_tls"
+            )
 
         self._register_routes()
 
@@ -892,46 +1751,210 @@ class App:
         self.log_requests = log_enabled
 
         logger.info(f"Started server process [{os.getpid()}]")
+        if self._is_cffi and getattr(lib, "xyra_event_backend", None) is not None:
+            logger.info(f"Event backend: {ffi.string(lib.xyra_event_backend()).decode()}")
         logger.info("Waiting for application startup.")
         logger.info("Application startup complete.")
-        logger.info(f"Xyra server running on http://{host}:{port}")
+        listen_fd = None
+        if os.environ.get("XYRA_RELOAD_CHILD") == "1":
+            listen_fd = _inherited_listen_fd()
+        bind_path = unix_socket
+        if unix_socket and listen_fd is None and os.environ.get("XYRA_RELOAD_CHILD") == "1":
+            # Bind beside the live socket and rename over it once listening:
+            # new connections switch atomically while the old server drains.
+            bind_path = f"{unix_socket}.{os.getpid()}"
+
+        url_host = f"[{host}]" if ":" in host else host
+        scheme = "https" if self._tls else "http"
+        if unix_socket:
+            address = f"unix:{unix_socket}"
+            logger.info(f"Xyra server running on {address}")
+        else:
+            address = f"{url_host}:{port}"
+            logger.info(f"Xyra server running on {scheme}://{address}")
         if self.swagger_options:
             swagger_ui_path = self.swagger_options.get("swagger_ui_path", "/docs")
-            logger.info(f"API docs available at http://{host}:{port}{swagger_ui_path}")
+            logger.info(f"API docs available at {scheme}://{url_host}:{port}{swagger_ui_path}")
 
         if self._is_cffi:
             @ffi.callback("void(bool, void*)")
             def _listen_cb(success, user_data):
                 if success:
-                    logger.info(f"Listening on port {port}")
+                    if bind_path != unix_socket:
+                        os.replace(bind_path, unix_socket)
+                    logger.info(f"Listening on {address}")
+                    _notify_ready()
                 else:
-                    logger.error(f"Failed to listen on port {port}")
+                    logger.error(f"Failed to listen on {address}")
             self._cffi_callbacks.append(_listen_cb)
-            lib.xyra_app_listen(self._app, port, _listen_cb, ffi.NULL)
-            lib.xyra_app_run(self._app)
+            restore_sigterm = None
+            if graceful_timeout is not None:
+                restore_sigterm = self._shutdown_on_sigterm(graceful_timeout)
+            try:
+                if listen_fd is not None:
+                    lib.xyra_app_listen_fd(self._app, listen_fd, _listen_cb, ffi.NULL)
+                elif unix_socket:
+                    lib.xyra_app_listen_unix(self._app, bind_path.encode(), _listen_cb, ffi.NULL)
+                elif getattr(lib, "xyra_app_listen_host", None) is not None:
+                    lib.xyra_app_listen_host(
+                        self._app, host.encode(), port, 0, _listen_cb, ffi.NULL
+                    )
+                else:
+                    lib.xyra_app_listen(self._app, port, _listen_cb, ffi.NULL)
+                loop_threads = []
+                if threads > 1:
+                    loop_threads = self._start_loop_threads(
+                        threads - 1, host, port, graceful_timeout or 0.0, listen_fd
+                    )
+                lib.xyra_app_run(self._app)
+                if loop_threads:
+                    if self._shutdown_timeout is None:
+                        self.shutdown(graceful_timeout or 0.0)
+                    for thread in loop_threads:
+                        thread.join(self._shutdown_timeout + 5)
+                if self._shutdown_timeout is not None:
+                    self._drain_async_tasks(self._shutdown_timeout)
+                    logger.info("Shutdown complete.")
+            finally:
+                if restore_sigterm is not None:
+                    restore_sigterm()
         else:
-            self._app.listen(port, lambda config: logger.info(f"Listening on port {port}"))
+            def on_listen(config):
+                logger.info(f"Listening on port {port}")
+                _notify_ready()
+
+            self._app.listen(port, on_listen)
             self._app.run()
 
+    def shutdown(self, timeout: float = 30.0) -> None:
+        """
+        Stop the server gracefully; safe to call from any thread.
+
+        Stops accepting connections, sends WebSocket clients a 1001 close,
+        and lets in-flight requests finish (closing their connections
+        instead of keeping them alive). run_server returns once everything
+        has drained, or after timeout seconds with the rest closed forcibly.
+        """
+        if timeout < 0:
+            raise ValueError("timeout must not be negative")
+        self._shutdown_timeout = timeout
+        if self._is_cffi and getattr(lib, "xyra_app_shutdown", None) is not None:
+            for app in [self, *self._thread_apps]:
+                lib.xyra_app_shutdown(app._app, int(timeout * 1000))
+        else:
+            self._app.close()
+
+    def _close_now(self) -> None:
+        """Cut a graceful shutdown short: close every connection now."""
+        self._shutdown_timeout = 0.0
+        if self._is_cffi and getattr(lib, "xyra_app_close", None) is not None:
+            for app in [self, *self._thread_apps]:
+                lib.xyra_app_close(app._app)
+        else:
+            self._app.close()
+
+    def _shutdown_on_sigterm(self, timeout: float) -> Callable[[], None]:
+        """
+        Route SIGTERM to shutdown(timeout); a second SIGTERM ends the drain
+        at once.
+
+        The main thread sits in the native event loop, where Python signal
+        handlers only run once Python code does. The C-level handler writes
+        the signal's wakeup fd right away though, so a thread reading it does
+        the work. No signal mask changes: threads and subprocesses started
+        by handlers can still be terminated with SIGTERM.
+
+        Returns a function that restores the previous handler, to be called
+        once the server has stopped.
+        """
+        if sys.platform == "win32" or threading.current_thread() is not threading.main_thread():
+            return lambda: None
+
+        read_fd, write_fd = os.pipe()
+        os.set_blocking(write_fd, False)
+        previous_handler = signal.signal(signal.SIGTERM, lambda signum, frame: None)
+        previous_wakeup_fd = signal.set_wakeup_fd(write_fd, warn_on_full_buffer=False)
+
+        def watch_wakeups():
+            received = 0
+            # One byte per signal number; EOF once restore closes write_fd
+            with os.fdopen(read_fd, "rb", buffering=0) as wakeups:
+                while data := wakeups.read(512):
+                    for _ in range(data.count(signal.SIGTERM)):
+                        received += 1
+                        if received == 1:
+                            get_logger("xyra").info("SIGTERM received, shutting down gracefully.")
+                            self.shutdown(timeout)
+                        elif received == 2:
+                            get_logger("xyra").warning("Second SIGTERM received, closing remaining connections.")
+                            self._close_now()
+
+        threading.Thread(target=watch_wakeups, daemon=True, name="xyra-sigterm").start()
+
+        def restore():
+            signal.set_wakeup_fd(previous_wakeup_fd)
+            signal.signal(signal.SIGTERM, signal.SIG_DFL if previous_handler is None else previous_handler)
+            os.close(write_fd)
+
+        return restore
+
+    def _drain_async_tasks(self, timeout: float) -> None:
+        """Give async handlers still running on the asyncio loop time to finish."""
+        loop = getattr(self, "_loop", None)
+        if loop is None or not loop.is_running():
+            return
+
+        async def wait_pending():
+            current = asyncio.current_task()
+            pending = [task for task in asyncio.all_tasks() if task is not current]
+            if pending:
+                await asyncio.wait(pending, timeout=timeout)
+
+        try:
+            asyncio.run_coroutine_threadsafe(wait_pending(), loop).result(timeout + 1)
+        except Exception:
+            get_logger("xyra").warning("Async handlers did not finish before shutdown")
+
     def listen(
         self,
         port: int = 8000,
         host: str = "localhost",
         reload: bool = False,
         logger: bool = False,
+        unix_socket: str | None = None,
+        reload_watch: bool = True,
+        threads: int = 1,
+        socket_options: dict[str, Any] | None = None,
+        ssl_certfile: str | None = None,
+        ssl_keyfile: str | None = None,
+        ssl_keyfile_password: str | None = None,
     ):
         """Alias for run_server method with default logger disabled."""
-        # Check if port is already in use
+        if os.environ.get("XYRA_RELOAD_CHILD") == "1" or "XYRA_WORKER_ID" in os.environ:
+            # Reload replacements and supervisor workers bind next to a live
+            # listener (SO_REUSEPORT)
+            return self.run_server(
+                port, host, reload, logger, unix_socket,
+                reload_watch=reload_watch, threads=threads, socket_options=socket_options,
+                ssl_certfile=ssl_certfile, ssl_keyfile=ssl_keyfile,
+                ssl_keyfile_password=ssl_keyfile_password,
+            )
+        if unix_socket:
+            _prepare_unix_socket(unix_socket)
+            return self.run_server(
+                port, host, reload, logger, unix_socket,
+                reload_watch=reload_watch, threads=threads, socket_options=socket_options,
+                ssl_certfile=ssl_certfile, ssl_keyfile=ssl_keyfile,
+                ssl_keyfile_password=ssl_keyfile_password,
+            )
 
-        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-        try:
-            sock.bind((host, port))
-            sock.close()
-        except OSError as e:
-            raise RuntimeError(
-                f"Port {port} is already in use. Only one instance of Xyra can run per port."
-            ) from e
-        return self.run_server(port, host, reload, logger)
+        ensure_port_free(host, port)
+        return self.run_server(
+            port, host, reload, logger,
+            reload_watch=reload_watch, threads=threads, socket_options=socket_options,
+            ssl_certfile=ssl_certfile, ssl_keyfile=ssl_keyfile,
+            ssl_keyfile_password=ssl_keyfile_password,
+        )
 
     @property
     def router(self):
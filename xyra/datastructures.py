@@ -1,4 +1,7 @@
 import re
+import socket
+from collections.abc import Iterable
+from ipaddress import IPv6Address, ip_address, ip_network
 
 try:
     from multidict import CIMultiDict
@@ -9,7 +12,7 @@ except ImportError:
 
 try:
 
-    from ._libxyra import lib
+    from ._native import lib
     def has_control_chars(s: str) -> bool:
         b = s.encode('utf-8')
         return lib.xyra_has_control_chars(b, len(b))
@@ -74,3 +77,167 @@ class Headers(CIMultiDict):
 
 class QueryParams(CIMultiDict):
     pass
+
+
+try:
+    from ._native import ffi as _ffi
+    from ._native import lib as _lib
+except ImportError:
+    _ffi = None
+    _lib = None
+
+
+def pack_ip(ip: str) -> bytes | None:
+    """Convert an IPv4/IPv6 string to its packed form, or None if invalid."""
+    try:
+        family = socket.AF_INET6 if ":" in ip else socket.AF_INET
+        return socket.inet_pton(family, ip)
+    except (OSError, TypeError, ValueError):
+        return None
+
+
+def unpack_ip(packed: bytes) -> str | None:
+    """Convert a packed 4 or 16 byte address back to its string form."""
+    if len(packed) == 4:
+        return socket.inet_ntop(socket.AF_INET, packed)
+    if len(packed) == 16:
+        return socket.inet_ntop(socket.AF_INET6, packed)
+    return None
+
+
+def parse_forwarded_element(element: str) -> dict[str, str]:
+    """
+    Parse one element of an RFC 7239 Forwarded header into its parameters.
+
+    Example: 'for="[2001:db8::17]:4711";proto=https' ->
+    {"for": "[2001:db8::17]:4711", "proto": "https"}
+    """
+    params = {}
+    for pair in element.split(";"):
+        key, sep, value = pair.strip().partition("=")
+        if not sep:
+            continue
+        value = value.strip()
+        if len(value) >= 2 and value[0] == '"' and value[-1] == '"':
+            value = value[1:-1]
+        params.setdefault(key.lower(), value)
+    return params
+
+
+def forwarded_for_node(element: str) -> str:
+    """Extract the bare address from the for= parameter of a Forwarded element."""
+    node = parse_forwarded_element(element).get("for", "")
+    if node.startswith("["):
+        end = node.find("]")
+        return node[1:end] if end != -1 else ""
+    if node.count(":") == 1:
+        # IPv4 with port
+        node = node.split(":", 1)[0]
+    return node
+
+
+class IPSet:
+    """
+    A set of IPv4/IPv6 networks with fast membership tests.
+
+    Backed by the native prefix trie when the extension is loaded, so a lookup
+    is a single C call however many networks are configured. Falls back to a
+    list of ip_network objects otherwise. IPv4-mapped IPv6 addresses match
+    their IPv4 networks.
+    """
+
+    def __init__(self, networks: Iterable[str] = ()):
+        self._native = None
+        self._networks: list = []
+        if _lib is not None and getattr(_lib, "xyra_ip_set_create", None) is not None:
+            self._native = _ffi.gc(_lib.xyra_ip_set_create(), _lib.xyra_ip_set_destroy)
+
+        for network in networks:
+            self.add(network)
+
+    def add(self, network: str) -> None:
+        """
+        Add an IP address or CIDR network.
+
+        Raises:
+            ValueError: If the network is invalid.
+        """
+        # strict=False allows host bits to be set (e.g., 192.168.1.1/24)
+        # and also handles single IPs correctly (e.g., 127.0.0.1 -> /32)
+        net = ip_network(network, strict=False)
+        if self._native is not None:
+            packed = net.network_address.packed
+            if not _lib.xyra_ip_set_add(self._native, packed, len(packed), net.prefixlen):
+                raise ValueError(f"Invalid network: {network!r}")
+        else:
+            self._networks.append(net)
+
+    def contains(self, ip_bytes: bytes) -> bool:
+        """Check a packed address (4 or 16 bytes, as returned by inet_pton)."""
+        if self._native is not None:
+            return bool(_lib.xyra_ip_set_contains(self._native, ip_bytes, len(ip_bytes)))
+
+        try:
+            addr = ip_address(ip_bytes)
+        except ValueError:
+            return False
+        if isinstance(addr, IPv6Address) and addr.ipv4_mapped:
+            addr = addr.ipv4_mapped
+        return any(addr in network for network in self._networks)
+
+    def __contains__(self, ip: str) -> bool:
+        packed = pack_ip(ip)
+        return packed is not None and self.contains(packed)
+
+    def resolve_forwarded(
+        self, chain: str, rfc7239: bool = False
+    ) -> tuple[str | None, int]:
+        """
+        Resolve the client address from a forwarding chain.
+
+        Walks X-Forwarded-For (or an RFC 7239 Forwarded header when rfc7239 is
+        set) from right to left, skipping hops contained in this set. A fully
+        trusted chain resolves to its leftmost hop.
+
+        Returns:
+            (client_ip, peeled) where peeled is the number of trusted hops
+            skipped and client_ip is None if the resolved hop is not a valid
+            IP address.
+        """
+        if self._native is not None and getattr(
+            _lib, "xyra_ip_set_resolve_forwarded", None
+        ) is not None:
+            c_chain = chain.encode("utf-8")
+            out_addr = _ffi.new("char[]", 16)
+            out_len = _ffi.new("size_t*")
+            peeled = _lib.xyra_ip_set_resolve_forwarded(
+                self._native, c_chain, len(c_chain), rfc7239, out_addr, out_len
+            )
+            if out_len[0] == 0:
+                return None, peeled
+            return unpack_ip(_ffi.buffer(out_addr, out_len[0])[:]), peeled
+
+        # SECURITY: Limit the number of hops processed to prevent DoS via
+        # CPU/Memory exhaustion. 20 hops is more than enough for any
+        # reasonable architecture.
+        hops = [hop.strip() for hop in chain.rsplit(",", 20)]
+        if rfc7239:
+            hops = [forwarded_for_node(hop) for hop in hops]
+
+        peeled = 0
+        client_ip = hops[0]
+        for i in reversed(range(len(hops))):
+            if i == 0 or hops[i] not in self:
+                client_ip = hops[i]
+                break
+            peeled += 1
+
+        try:
+            addr = ip_address(client_ip)
+        except ValueError:
+            return None, peeled
+        # Same form as the native path, so rate-limit and log keys do not
+        # depend on the build: canonical, IPv4-mapped as plain IPv4.
+        if isinstance(addr, IPv6Address) and addr.ipv4_mapped:
+            addr = addr.ipv4_mapped
+        return str(addr), peeled
@@ -10,6 +10,7 @@ from .cors import CorsMiddleware, cors
 from .csrf import CSRFMiddleware, csrf
 from .gzip import GzipMiddleware, gzip_middleware
 from .httpsredirect import HTTPSRedirectMiddleware, https_redirect_middleware
+from .ip_filter import IPFilterMiddleware, ip_filter
 from .rate_limiter import RateLimiter, RateLimitMiddleware, rate_limiter
 from .trustedhost import TrustedHostMiddleware, trusted_host_middleware
 
@@ -22,6 +23,8 @@ __all__ = [
     "gzip_middleware",
     "HTTPSRedirectMiddleware",
     "https_redirect_middleware",
+    "IPFilterMiddleware",
+    "ip_filter",
     "RateLimiter",
     "RateLimitMiddleware",
     "rate_limiter",
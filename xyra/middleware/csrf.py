@@ -3,11 +3,37 @@ import hashlib
 import hmac
 import os
 import secrets
-from http.cookies import SimpleCookie
 
 from ..request import Request
 from ..response import Response
 
+try:
+    from .._native import ffi as _ffi
+    from .._native import lib as _lib
+except ImportError:
+    _ffi = None
+    _lib = None
+
+
+def _find_cookie(header: str, name: str) -> str | None:
+    """
+    The value of cookie name in a Cookie header, parsed like the native
+    xyra_cookie_find: quotes are stripped, and a name sent twice with
+    different values (cookie tossing) counts as absent.
+    """
+    result = None
+    for pair in header.split(";"):
+        key, sep, value = pair.lstrip(" \t").partition("=")
+        if not sep or key.rstrip(" \t") != name:
+            continue
+        value = value.strip(" \t")
+        if len(value) >= 2 and value[0] == value[-1] == '"':
+            value = value[1:-1]
+        if result is not None and value != result:
+            return None
+        result = value
+    return result
+
 
 class CSRFMiddleware:
     """
@@ -41,6 +67,9 @@ class CSRFMiddleware:
             )
 
         self.secret_key = secret_key
+        self._secret = secret_key.encode()
+        # Signing, masking and cookie lookup run natively when available
+        self._native = _lib is not None and getattr(_lib, "xyra_csrf_verify", None) is not None
 
         self.header_name = header_name
         self.exempt_methods = exempt_methods or ["GET", "HEAD", "OPTIONS"]
@@ -60,6 +89,12 @@ class CSRFMiddleware:
 
     def _sign_token(self, token: str) -> str:
         """Sign a token using HMAC."""
+        if self._native:
+            token_b = token.encode()
+            out = _ffi.new("char[]", len(token_b) + 65)
+            n = _lib.xyra_csrf_sign(self._secret, len(self._secret), token_b, len(token_b), out)
+            return _ffi.buffer(out, n)[:].decode()
+
         signature = hmac.new(
             self.secret_key.encode(), token.encode(), hashlib.sha256
         ).hexdigest()
@@ -70,6 +105,15 @@ class CSRFMiddleware:
         if not signed_token or "." not in signed_token:
             return None
 
+        if self._native:
+            signed_b = signed_token.encode()
+            token_len = _ffi.new("size_t*")
+            if _lib.xyra_csrf_verify(
+                self._secret, len(self._secret), signed_b, len(signed_b), token_len
+            ):
+                return signed_b[: token_len[0]].decode()
+            return None
+
         try:
             token, signature = signed_token.rsplit(".", 1)
             expected_signature = hmac.new(
@@ -97,12 +141,26 @@ class CSRFMiddleware:
 
         salt = secrets.token_bytes(32)
         token_bytes = token.encode()
+        if self._native:
+            out = _ffi.new("char[]", (len(token_bytes) + 32) * 4 // 3 + 1)
+            n = _lib.xyra_csrf_mask(token_bytes, len(token_bytes), salt, out)
+            return _ffi.buffer(out, n)[:].decode()
+
         # XOR token with salt (repeating salt if necessary)
         masked = bytes(t ^ salt[i % 32] for i, t in enumerate(token_bytes))
         return base64.urlsafe_b64encode(salt + masked).decode().rstrip("=")
 
     def _unmask_token(self, masked_token: str) -> str | None:
         """Unmask a token masked with _mask_token."""
+        if self._native:
+            masked_b = masked_token.encode()
+            out = _ffi.new("char[]", len(masked_b) + 1)
+            n = _lib.xyra_csrf_unmask(masked_b, len(masked_b), out)
+            try:
+                return _ffi.buffer(out, n)[:].decode() if n else None
+            except UnicodeDecodeError:
+                return None
+
         try:
             # Add back base64 padding if missing
             missing_padding = len(masked_token) % 4
@@ -121,22 +179,23 @@ class CSRFMiddleware:
             return None
 
     def _get_cookie(self, request: Request, name: str) -> str | None:
-        """Extract cookie value from request headers using SimpleCookie."""
+        """Extract a cookie value from the request headers (see _find_cookie)."""
         cookie_header = request.get_header("cookie")
         if not cookie_header:
             return None
 
-        try:
-            # SimpleCookie handles complex parsing (quotes, etc.)
-            cookie = SimpleCookie()
-            cookie.load(cookie_header)
-            if name in cookie:
-                return cookie[name].value
-        except Exception:
-            # Malformed cookie header, treat as no cookie
+        if self._native:
+            header_b = cookie_header.encode()
+            name_b = name.encode()
+            out_value = _ffi.new("const char**")
+            out_len = _ffi.new("size_t*")
+            if _lib.xyra_cookie_find(
+                header_b, len(header_b), name_b, len(name_b), out_value, out_len
+            ):
+                return _ffi.buffer(out_value[0], out_len[0])[:].decode()
             return None
 
-        return None
+        return _find_cookie(cookie_header, name)
 
     async def _get_token_from_request(self, request: Request) -> str | None:
         """Extract CSRF token from request header or form body."""
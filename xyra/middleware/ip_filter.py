@@ -0,0 +1,70 @@
+"""
+IP Filter Middleware for Xyra Framework
+
+Allows or denies requests based on the client IP address.
+"""
+
+from ..datastructures import IPSet
+from ..request import Request
+from ..response import Response
+
+
+class IPFilterMiddleware:
+    """
+    Middleware that allows or denies requests by client IP address or network.
+
+    Deny rules take precedence over allow rules. When an allow list is given,
+    only addresses inside it are accepted. Lookups go through the native prefix
+    trie, so large lists cost the same as small ones.
+
+    Place it after ProxyHeadersMiddleware to filter on the resolved client IP
+    rather than the immediate proxy.
+    """
+
+    def __init__(
+        self,
+        allow: list[str] | None = None,
+        deny: list[str] | None = None,
+    ):
+        """
+        Initialize IP filter middleware.
+
+        Args:
+            allow: IPs or CIDR networks allowed to access the app (None allows all).
+                   Examples: ["10.0.0.0/8", "2001:db8::/32"]
+            deny: IPs or CIDR networks that are always rejected.
+
+        Raises:
+            ValueError: If an entry is not a valid IP address or network.
+        """
+        self.allow = IPSet(allow) if allow is not None else None
+        self.deny = IPSet(deny or [])
+
+    def is_allowed(self, ip: str) -> bool:
+        """Check whether a client IP passes the filter."""
+        if ip in self.deny:
+            return False
+        if self.allow is not None:
+            # SECURITY: Unparsable addresses (e.g. "unknown") never match an allow list.
+            return ip in self.allow
+        return True
+
+    def __call__(self, request: Request, response: Response) -> None:
+        """Reject the request with 403 if the client IP is filtered."""
+        if not self.is_allowed(request.remote_addr):
+            response.status(403)
+            response.json({"error": "Forbidden"})
+            response._ended = True
+
+
+def ip_filter(
+    allow: list[str] | None = None, deny: list[str] | None = None
+) -> IPFilterMiddleware:
+    """
+    Create an IP filter middleware instance.
+
+    Args:
+        allow: IPs or CIDR networks allowed to access the app (None allows all).
+        deny: IPs or CIDR networks that are always rejected.
+    """
+    return IPFilterMiddleware(allow=allow, deny=deny)
@@ -4,8 +4,9 @@ Proxy Headers Middleware for Xyra Framework
 Safely resolves the client IP address when running behind trusted proxies.
 """
 
-from ipaddress import ip_address, ip_network
+from ipaddress import ip_address
 
+from ..datastructures import IPSet, forwarded_for_node, parse_forwarded_element
 from ..logger import get_logger
 from ..request import Request
 from ..response import Response
@@ -15,8 +16,12 @@ class ProxyHeadersMiddleware:
     """
     Middleware for correctly resolving client IP addresses when behind trusted proxies.
 
-    This middleware inspects the X-Forwarded-For header to determine the real client IP,
-    but only if the request comes from a trusted proxy. This prevents IP spoofing attacks.
+    This middleware inspects the X-Forwarded-For header (or the RFC 7239 Forwarded
+    header when X-Forwarded-For is absent) to determine the real client IP, but only
+    if the request comes from a trusted proxy. This prevents IP spoofing attacks.
+
+    PERF: Trusted networks are held in an IPSet, so with the native extension loaded
+    the whole chain is resolved in a single C call.
     """
 
     def __init__(
@@ -35,7 +40,7 @@ class ProxyHeadersMiddleware:
                                  Defaults to 1 if "*" is used and count is not provided.
         """
         self.trust_all = "*" in trusted_proxies
-        self.trusted_networks = []
+        self.trusted_networks = IPSet()
         self.trusted_proxy_count = trusted_proxy_count
 
         if self.trust_all:
@@ -55,10 +60,7 @@ class ProxyHeadersMiddleware:
             for proxy in trusted_proxies:
                 try:
                     # Support both single IPs and CIDR networks
-                    # strict=False allows host bits to be set (e.g., 192.168.1.1/24)
-                    # and also handles single IPs correctly (e.g., 127.0.0.1 -> /32)
-                    network = ip_network(proxy, strict=False)
-                    self.trusted_networks.append(network)
+                    self.trusted_networks.add(proxy)
                 except ValueError:
                     # Invalid IP/CIDR, skip it
                     continue
@@ -68,14 +70,7 @@ class ProxyHeadersMiddleware:
         if self.trust_all:
             return True
 
-        try:
-            ip = ip_address(ip_str)
-            for network in self.trusted_networks:
-                if ip in network:
-                    return True
-            return False
-        except ValueError:
-            return False
+        return ip_str in self.trusted_networks
 
     def __call__(self, req: Request, res: Response) -> None:
         """
@@ -96,6 +91,10 @@ class ProxyHeadersMiddleware:
             return
 
         xff = req.get_header("x-forwarded-for")
+        rfc7239 = False
+        if not xff:
+            xff = req.get_header("forwarded")
+            rfc7239 = True
         if not xff:
             return
 
@@ -105,93 +104,67 @@ class ProxyHeadersMiddleware:
         if len(xff) > 2048:
             return
 
-        # Parse XFF list
-        try:
-            # Split by comma and strip whitespace
-            # XFF format: client, proxy1, proxy2
-            # SECURITY: Limit the number of IPs processed to prevent DoS via CPU/Memory exhaustion.
-            # We only care about the last few IPs (the trusted chain).
-            # 20 hops is more than enough for any reasonable architecture.
-            raw_ips = xff.rsplit(",", 20)
-            ips = [ip.strip() for ip in raw_ips]
-        except Exception:
-            return
-
-        if not ips:
-            return
-
         # Walk backwards through the chain
         # We start by assuming the last IP in the list is the one that connected to us
         # (if trusted). If trusted, we check the one before it.
         # The first untrusted IP we encounter is the client IP.
-
-        client_ip = remote_addr  # Default fallback if logic fails or all trusted
-        client_index = -1  # Index in the `ips` list (from left) that corresponds to the client
-
+        # peeled_count is the number of proxies stripped from the end of the list.
+        client_ip: str | None
         if self.trust_all:
             # SECURITY: If trusting all, we rely on trusted_proxy_count to limit recursion.
             # Without this, we would trust every IP in the chain, allowing spoofing.
             # We trust 'remote_addr' (the immediate proxy) plus (trusted_proxy_count - 1) proxies in the header.
-            # trusted_proxy_count is at least 1.
-            max_hops = self.trusted_proxy_count - 1  # type: ignore
+            # SECURITY: Limit the number of IPs processed to prevent DoS via CPU/Memory exhaustion.
+            ips = [ip.strip() for ip in xff.rsplit(",", 20)]
+            if rfc7239:
+                ips = [forwarded_for_node(ip) for ip in ips]
 
-            target_index = len(ips) - 1 - max_hops
-            if target_index >= 0:
-                client_ip = ips[target_index]
-                client_index = target_index
-            else:
-                # If the target_index is negative, the chain is shorter than expected.
-                # We default to the first IP (originator).
-                if ips:
-                    client_ip = ips[0]
-                    client_index = 0
+            # If the chain is shorter than expected we default to the first IP (originator).
+            peeled_count = min(self.trusted_proxy_count - 1, len(ips) - 1)  # type: ignore
+            client_ip = ips[len(ips) - 1 - peeled_count]
+            try:
+                # Ensure it's a valid IP address
+                ip_address(client_ip)
+            except ValueError:
+                client_ip = None
         else:
-            # Standard logic using IP whitelist
-            # Iterate right to left
-            for i in reversed(range(len(ips))):
-                if self._is_trusted(ips[i]):
-                    continue
-                else:
-                    client_ip = ips[i]
-                    client_index = i
-                    break
-            else:
-                # All IPs in XFF are trusted (and remote_addr is trusted).
-                # This implies the client itself is a trusted entity (e.g. internal service)
-                # or the chain is fully trusted.
-                # In this case, the "client" is the first IP in the list (the originator).
-                if ips:
-                    client_ip = ips[0]
-                    client_index = 0
+            # Standard logic using the trusted network set. If every hop is trusted
+            # the client itself is a trusted entity (e.g. internal service) and the
+            # originator (first IP in the list) is used.
+            client_ip, peeled_count = self.trusted_networks.resolve_forwarded(
+                xff, rfc7239
+            )
 
         # Update the request's remote_addr cache
-        # Validate that the resolved IP is a valid IP string
-        try:
-            # Ensure it's a valid IP address
-            ip_address(client_ip)
-            # Set the cache directly
-            req._remote_addr_cache = client_ip
-        except ValueError:
+        if client_ip is None:
             # SECURITY: If IP is invalid, we MUST NOT leave remote_addr as the trusted proxy IP.
             # This would allow attackers to bypass IP-based rate limits or blocklists by
             # making their requests appear to come from the trusted proxy itself.
             # We set it to "unknown" so they share a single rate limit bucket (or get blocked).
             logger = get_logger("xyra")
             logger.warning(
-                f"Security Warning: Resolved client IP '{client_ip}' from trusted proxy is invalid. "
+                "Security Warning: Resolved client IP from trusted proxy is invalid. "
                 "Setting remote_addr to 'unknown' to prevent IP spoofing/DoS attribution to proxy."
             )
             req._remote_addr_cache = "unknown"
             return
 
+        req._remote_addr_cache = client_ip
+
+        if rfc7239:
+            # Forwarded carries proto/host in the same element as the client hop.
+            elements = xff.rsplit(",", 20)
+            params = parse_forwarded_element(elements[len(elements) - 1 - peeled_count])
+            if params.get("proto"):
+                req._scheme_cache = params["proto"].lower()
+            if params.get("host"):
+                self._apply_host(req, params["host"])
+            return
+
         # Handle X-Forwarded-Proto, X-Forwarded-Host, X-Forwarded-Port
         # We assume that the proxy chain is consistent for these headers.
         # We use the same 'depth' (peeled proxies) to find the correct value.
 
-        # Number of proxies stripped from the end of the list
-        # ips = [Client, Proxy1] (len=2). client_index=0. peeled = 2 - 1 - 0 = 1.
-        peeled_count = len(ips) - 1 - client_index
-
         def get_forwarded_value(header_name: str) -> str | None:
             header_val = req.get_header(header_name)
             if not header_val:
@@ -235,28 +208,7 @@ class ProxyHeadersMiddleware:
         # Update Host and Port (handling host strings with port, like example.com:8080)
         host = get_forwarded_value("x-forwarded-host")
         if host:
-            if host.startswith("["):
-                # IPv6 literal with port [::1]:8080
-                end = host.find("]")
-                if end != -1:
-                    if len(host) > end + 1 and host[end + 1] == ":":
-                        try:
-                            req._port_cache = int(host[end + 2:])
-                        except ValueError:
-                            pass
-                    req._host_cache = host[:end + 1]
-                else:
-                    req._host_cache = host
-            elif ":" in host:
-                # IPv4 or Domain with port
-                parts = host.split(":", 1)
-                req._host_cache = parts[0]
-                try:
-                    req._port_cache = int(parts[1])
-                except ValueError:
-                    pass
-            else:
-                req._host_cache = host
+            self._apply_host(req, host)
 
         # Update Port from explicit header (overrides host port if present)
         port_str = get_forwarded_value("x-forwarded-port")
@@ -266,6 +218,32 @@ class ProxyHeadersMiddleware:
             except ValueError:
                 pass
 
+    @staticmethod
+    def _apply_host(req: Request, host: str) -> None:
+        """Update host and port caches from a host string like example.com:8080."""
+        if host.startswith("["):
+            # IPv6 literal with port [::1]:8080
+            end = host.find("]")
+            if end != -1:
+                if len(host) > end + 1 and host[end + 1] == ":":
+                    try:
+                        req._port_cache = int(host[end + 2:])
+                    except ValueError:
+                        pass
+                req._host_cache = host[:end + 1]
+            else:
+                req._host_cache = host
+        elif ":" in host:
+            # IPv4 or Domain with port
+            parts = host.split(":", 1)
+            req._host_cache = parts[0]
+            try:
+                req._port_cache = int(parts[1])
+            except ValueError:
+                pass
+        else:
+            req._host_cache = host
+
 
 def proxy_headers(
     trusted_proxies: list[str], trusted_proxy_count: int | None = None
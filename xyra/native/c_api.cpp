@@ -1,5 +1,9 @@
 #include "c_api.h"
 #include "App.h"
+#include "csrf.h"
+#include "ip_set.h"
+#include "pubsub_bus.h"
+#include "rate_limiter.h"
 #include <string>
 #include <string_view>
 #include <atomic>
@@ -8,10 +12,46 @@
 #include <algorithm>
 #include <cctype>
 #include <sstream>
+#include <thread>
 #include <iomanip>
 #include <iostream>
+#include <chrono>
+#include <cerrno>
 #include <cstring>
+#include <unordered_map>
 #include <vector>
+#include <zlib.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef LIBUS_USE_IO_URING
+#include <liburing.h>
+#endif
+
+#ifdef XYRA_TLS
+#include <openssl/rand.h>
+#include <openssl/ssl.h>
+#endif
+
+// TLS is a build choice (XYRA_TLS=ON): uWS types differ between plain and
+// SSL sockets, so a TLS build serves HTTPS from every app.
+#ifdef XYRA_TLS
+static constexpr bool XYRA_SSL = true;
+typedef uWS::SSLApp xyra_uws_app;
+#else
+static constexpr bool XYRA_SSL = false;
+typedef uWS::App xyra_uws_app;
+#endif
 
 // --- Utility Functions from bindings.cpp ---
 static bool cpp_has_control_chars(std::string_view s) {
@@ -181,11 +221,115 @@ void xyra_format_cookie(
     }
 }
 
+// --- IP sets ---
+
+struct xyra_ip_set {
+    xyra::IpSet set;
+};
+
+xyra_ip_set_t* xyra_ip_set_create(void) {
+    return new xyra_ip_set();
+}
+
+void xyra_ip_set_destroy(xyra_ip_set_t* set) {
+    delete set;
+}
+
+bool xyra_ip_set_add(xyra_ip_set_t* set, const char* addr, size_t addr_len, int prefix_len) {
+    return set->set.insert(std::string_view(addr, addr_len), prefix_len);
+}
+
+bool xyra_ip_set_contains(const xyra_ip_set_t* set, const char* addr, size_t addr_len) {
+    return set->set.contains(std::string_view(addr, addr_len));
+}
+
+int xyra_ip_set_resolve_forwarded(const xyra_ip_set_t* trusted, const char* chain, size_t len, bool rfc7239, char* out_addr, size_t* out_addr_len) {
+    // SECURITY: Same bound as the Python middleware (rsplit(",", 20)).
+    xyra::IpKey client;
+    int peeled;
+    bool valid = xyra::resolve_forwarded(trusted->set, std::string_view(chain, len), rfc7239, 20, client, peeled);
+    *out_addr_len = valid ? client.to_bytes(reinterpret_cast<unsigned char*>(out_addr)) : 0;
+    return peeled;
+}
+
+// --- CSRF ---
+
+bool xyra_cookie_find(const char* header, size_t len, const char* name, size_t name_len, const char** out_value, size_t* out_len) {
+    bool found;
+    std::string_view value = xyra::find_cookie(std::string_view(header, len), std::string_view(name, name_len), found);
+    *out_value = value.data();
+    *out_len = value.length();
+    return found;
+}
+
+size_t xyra_csrf_sign(const char* secret, size_t secret_len, const char* token, size_t token_len, char* out) {
+    std::memmove(out, token, token_len);
+    out[token_len] = '.';
+    xyra::csrf_signature(std::string_view(secret, secret_len), std::string_view(out, token_len), out + token_len + 1);
+    return token_len + 1 + xyra::CSRF_SIGNATURE_HEX;
+}
+
+bool xyra_csrf_verify(const char* secret, size_t secret_len, const char* signed_token, size_t len, size_t* out_token_len) {
+    return xyra::csrf_verify(std::string_view(secret, secret_len), std::string_view(signed_token, len), *out_token_len);
+}
+
+size_t xyra_csrf_mask(const char* token, size_t len, const char* salt, char* out) {
+    std::string scratch(xyra::CSRF_SALT_SIZE + len, '\0');
+    return xyra::csrf_mask(std::string_view(token, len), reinterpret_cast<const unsigned char*>(salt),
+                           reinterpret_cast<unsigned char*>(scratch.data()), out);
+}
+
+size_t xyra_csrf_unmask(const char* masked, size_t len, char* out) {
+    size_t out_len;
+    if (!xyra::csrf_unmask(std::string_view(masked, len), reinterpret_cast<unsigned char*>(out), out_len)) return 0;
+    return out_len;
+}
+
 // --- Wrappers for App, Request, Response, WebSocket ---
 
+struct WebSocketData;
+
+// The xyra_websocket_t* passed to every callback of one socket. uWS frees
+// the socket's user data on close, so the handle is allocated apart from it
+// and reference counted: the socket holds one reference until its close
+// callback has returned, and every Python WebSocket holds one (see
+// xyra_ws_retain). ws is only dereferenced while is_closed is false.
+struct xyra_websocket {
+    uWS::WebSocket<XYRA_SSL, true, WebSocketData> *ws = nullptr;
+    std::atomic<bool> is_closed{false};
+    std::atomic<uint32_t> refs{1};
+    // Owning app, for publishes through its pub/sub bus
+    xyra_app_t *app = nullptr;
+    // Kept here rather than in WebSocketData so they outlive the socket.
+    uint64_t id = 0;
+    void *user_data = nullptr;
+};
+
 struct WebSocketData {
-    std::shared_ptr<std::atomic<bool>> is_closed;
-    WebSocketData() : is_closed(std::make_shared<std::atomic<bool>>(false)) {}
+    // permessage-deflate was offered on a SHARED_COMPRESSOR route, so the
+    // socket accepts the deflated body of a prepared message as is.
+    bool shared_deflate = false;
+    // Connection id (see xyra_ws_get_id); assigned on open.
+    uint64_t id = 0;
+    // Loop time (xyra_app::now_ms) of the last frame received.
+    uint64_t last_activity_ms = 0;
+    // Set on open; the socket's reference is released after close.
+    xyra_websocket *handle = nullptr;
+    // Peer address still counted towards max_connections_per_ip (see
+    // xyra_filter_connection); released on close.
+    bool counted = false;
+    xyra::IpKey peer;
+};
+
+// A payload encoded once and sent to any number of sockets. With compress
+// set, deflated holds the permessage-deflate body the shared compressor
+// would produce (it is reset after every message, so the output does not
+// depend on the socket); empty if there was nothing to deflate.
+struct xyra_prepared_message {
+    std::string payload;
+    std::string deflated;
+    int opcode;
+    bool compress;
 };
 
 struct xyra_request {
@@ -194,31 +338,698 @@ struct xyra_request {
 };
 
 struct xyra_response {
-    uWS::HttpResponse<false> *res;
+    uWS::HttpResponse<XYRA_SSL> *res;
     uWS::Loop *loop;
     std::shared_ptr<std::atomic<bool>> aborted;
     std::string remote_address;
+    // Owning app, for the drain flag (see xyra_app_shutdown)
+    xyra_app_t *app = nullptr;
+    // Keep-alive budget spent: close after this response (see
+    // xyra_app_set_http_timeouts)
+    bool last_on_connection = false;
 };
 
-struct xyra_websocket {
-    uWS::WebSocket<false, true, WebSocketData> *ws;
-    std::shared_ptr<std::atomic<bool>> is_closed;
+// Accumulates a route's incoming messages so Python is entered once per loop
+// iteration (or once per batch_max_messages / batch_max_bytes) instead of
+// once per frame.
+struct xyra_ws_batcher {
+    struct Pending {
+        // Referenced until delivered, in case the socket closes meanwhile
+        xyra_websocket *ws;
+        size_t offset;
+        size_t len;
+        int opcode;
+    };
+
+    xyra_ws_batch_cb cb;
+    void *user_data;
+    uint32_t max_messages;
+    uint32_t max_bytes;
+    std::vector<Pending> pending;
+    std::string data;
+    std::vector<xyra_ws_batch_entry_t> entries;
+    bool flushing = false;
+
+    void push(uWS::WebSocket<XYRA_SSL, true, WebSocketData> *ws, std::string_view message, int opcode) {
+        pending.push_back(Pending{xyra_ws_retain(ws->getUserData()->handle), data.size(), message.size(), opcode});
+        data.append(message);
+        if ((max_messages && pending.size() >= max_messages) || (max_bytes && data.size() >= max_bytes)) {
+            flush();
+        }
+    }
+
+    void flush() {
+        // The handler may close a socket, and close flushes before it is
+        // reported: that nested call must neither redeliver nor clear the
+        // batch being delivered.
+        if (flushing || pending.empty()) return;
+        flushing = true;
+
+        std::vector<Pending> batch;
+        std::string bytes;
+        std::vector<xyra_ws_batch_entry_t> list;
+        batch.swap(pending);
+        bytes.swap(data);
+        list.swap(entries);
+        list.clear();
+        for (const Pending &p : batch) {
+            list.push_back(xyra_ws_batch_entry_t{p.ws, bytes.data() + p.offset, p.len, p.opcode});
+        }
+        cb(list.data(), list.size(), user_data);
+
+        // Entries of sockets closed by the handler stay valid until here;
+        // their handles report closed (xyra_ws_is_closed).
+        for (const Pending &p : batch) xyra_ws_release(p.ws);
+        flushing = false;
+
+        // Reuse the buffers unless the handler queued more messages.
+        if (pending.empty()) {
+            batch.clear();
+            bytes.clear();
+            pending.swap(batch);
+            data.swap(bytes);
+        }
+        entries.swap(list);
+    }
+};
+
+// Copied out of xyra_tls_options_t so sibling apps can load the same
+// certificates; ticket_keys is generated once, so every loop can resume the
+// others' sessions.
+struct XyraTlsConfig {
+    std::string cert_file, key_file, passphrase, ca_file, ciphers;
+    uint32_t session_cache_size = 0;
+    uint32_t session_timeout = 0;
+    bool session_tickets = true;
+    std::string ticket_keys;
+
+    struct ServerName {
+        std::string hostname, cert_file, key_file, passphrase;
+    };
+    std::vector<ServerName> server_names;
+};
+
+// uSockets only polls listen sockets it created itself, so an inherited one
+// is served by a thread that accepts connections and hands each to the loop
+// (App::adoptSocket). The socket may be shared with other processes.
+struct xyra_fd_acceptor {
+    int listen_fd = -1;      // our duplicate; the caller keeps its own
+    int wake[2] = {-1, -1};  // written to stop the thread
+    std::thread thread;
+    // Not fallthrough: keeps the loop running, as a listen socket would.
+    us_timer_t *keepalive = nullptr;
+};
+
+// Open connections per peer address, HTTP and upgraded WebSocket alike.
+// Shared by an app and its siblings, so max_connections_per_ip holds for the
+// whole process rather than per event loop.
+struct xyra_connection_counts {
+    std::mutex mutex;
+    std::unordered_map<xyra::IpKey, uint32_t, xyra::IpKeyHash> counts;
+
+    uint32_t acquire(const xyra::IpKey &key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return ++counts[key];
+    }
+
+    void release(const xyra::IpKey &key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = counts.find(key);
+        if (it != counts.end() && --it->second == 0) counts.erase(it);
+    }
+};
+
+// All mutable state of the C API lives in xyra_app (or objects it owns);
+// there are no globals, so apps on different threads are independent of
+// each other.
+struct xyra_app {
+    xyra_uws_app app;
+    // The loop (and thread) the app was created on; uWS is not thread-safe
+    // and work from other threads has to be deferred onto it.
+    uWS::Loop *loop = uWS::Loop::get();
+    std::thread::id loop_thread = std::this_thread::get_id();
+    // Shared with sibling apps (see xyra_app_create_sibling); lock-free.
+    std::shared_ptr<xyra::RateLimiter> rate_limiter;
+
+    // Accept-time connection filtering (see xyra_app_set_connection_filter)
+    bool connection_filter_installed = false;
+    std::unique_ptr<xyra::IpSet> connection_deny;
+    std::unique_ptr<xyra::IpSet> connection_allow;
+    uint32_t max_connections_per_ip = 0;
+    std::shared_ptr<xyra_connection_counts> connections_per_ip;
+    // The HTTP response being upgraded to a WebSocket; its close event keeps
+    // the connection counted. Loop thread only.
+    void *upgrading = nullptr;
+
+    // Request limits (see xyra_app_set_request_limits); zero disables a field.
+    xyra_request_limits_t limits{};
+
+    // Socket tuning (see xyra_app_set_socket_options)
+    xyra_socket_options_t socket_options{};
+    bool socket_filter_installed = false;
+
+    // TLS settings (see xyra_app_set_tls), shared read-only with siblings
+    std::shared_ptr<const XyraTlsConfig> tls;
+
+    // Connection timeouts (see xyra_app_set_http_timeouts); requests served
+    // per open HTTP connection, loop thread only.
+    xyra_http_timeouts_t timeouts{};
+    bool timeouts_filter_installed = false;
+    std::unordered_map<void *, uint32_t> connection_requests;
+
+    // Cross-loop pub/sub (see xyra_app_join_pubsub)
+    std::shared_ptr<xyra::PubSubBus> bus;
+    uint64_t bus_member = 0;
+
+    // Steady-clock milliseconds, read once per loop iteration (pre handler)
+    // rather than on every WebSocket frame.
+    uint64_t now_ms = 0;
+
+    // Open WebSockets by connection id, for xyra_ws_defer. Loop thread only.
+    uint64_t next_socket_id = 1;
+    std::unordered_map<uint64_t, uWS::WebSocket<XYRA_SSL, true, WebSocketData> *> sockets;
+
+    // Graceful shutdown (see xyra_app_shutdown). draining is read by
+    // responses completed from other threads.
+    std::vector<us_listen_socket_t *> listen_sockets;
+    std::atomic<bool> draining{false};
+    us_timer_t *shutdown_timer = nullptr;
+
+    // Inherited listen socket (see xyra_app_listen_fd)
+    std::unique_ptr<xyra_fd_acceptor> fd_acceptor;
+
+    // Worker recycling (see xyra_app_set_max_requests)
+    uint64_t max_requests = 0;
+    uint64_t requests_served = 0;
+    uint32_t recycle_drain_ms = 0;
+};
+
+struct xyra_pubsub {
+    std::shared_ptr<xyra::PubSubBus> bus = std::make_shared<xyra::PubSubBus>();
 };
 
+static uint64_t xyra_steady_ms() {
+    return (uint64_t) std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* xyra_event_backend(void) {
+#if defined(LIBUS_USE_IO_URING)
+    return "io_uring";
+#elif defined(LIBUS_USE_LIBUV)
+    return "libuv";
+#elif defined(LIBUS_USE_KQUEUE)
+    return "kqueue";
+#else
+    return "epoll";
+#endif
+}
+
+bool xyra_event_backend_usable(void) {
+#ifdef LIBUS_USE_IO_URING
+    // Old kernels and seccomp profiles (common in containers) refuse
+    // io_uring_setup; uSockets would fail creating its loop.
+    struct io_uring ring;
+    if (io_uring_queue_init(8, &ring, 0) < 0) return false;
+    io_uring_queue_exit(&ring);
+#endif
+    return true;
+}
+
 xyra_app_t* xyra_app_create(void) {
-    return reinterpret_cast<xyra_app_t*>(new uWS::App());
+    xyra_app_t* app = new xyra_app();
+    app->now_ms = xyra_steady_ms();
+    app->loop->addPreHandler(app, [app](uWS::Loop *) {
+        app->now_ms = xyra_steady_ms();
+    });
+    return app;
 }
 
+static void xyra_stop_fd_acceptor(xyra_app_t* app);
+
 void xyra_app_destroy(xyra_app_t* app) {
-    delete reinterpret_cast<uWS::App*>(app);
+    app->loop->removePreHandler(app);
+    xyra_stop_fd_acceptor(app);
+    if (app->shutdown_timer) us_timer_close(app->shutdown_timer);
+    if (app->bus) app->bus->leave(app->bus_member);
+    delete app;
+}
+
+xyra_pubsub_t* xyra_pubsub_create(void) {
+    return new xyra_pubsub();
+}
+
+void xyra_pubsub_destroy(xyra_pubsub_t* bus) {
+    // Joined apps keep the bus alive until they are destroyed.
+    delete bus;
+}
+
+size_t xyra_pubsub_publish(xyra_pubsub_t* bus, const char* topic, size_t topic_len, const char* message, size_t msg_len, int opcode, bool compress) {
+    return bus->bus->publish(std::string_view(topic, topic_len), std::string_view(message, msg_len), opcode, compress);
+}
+
+static void xyra_join_bus(xyra_app_t* app, std::shared_ptr<xyra::PubSubBus> bus) {
+    if (app->bus) app->bus->leave(app->bus_member);
+    app->bus = std::move(bus);
+    app->bus_member = app->bus->join([app](const std::shared_ptr<const xyra::BusMessage> &msg) {
+        app->loop->defer([app, msg]() {
+            app->app.publish(msg->topic, msg->payload, (uWS::OpCode) msg->opcode, msg->compress);
+        });
+    });
+}
+
+void xyra_app_join_pubsub(xyra_app_t* app, xyra_pubsub_t* bus) {
+    xyra_join_bus(app, bus->bus);
+}
+
+void xyra_app_set_rate_limit(xyra_app_t* app, uint32_t requests, uint32_t window_seconds, size_t max_entries) {
+    if (requests == 0) {
+        app->rate_limiter.reset();
+        return;
+    }
+    app->rate_limiter = std::make_shared<xyra::RateLimiter>(requests, window_seconds, max_entries);
+}
+
+// Runs from the HTTP context's socket open (+1) and close (-1) handlers, i.e.
+// right after accept and before a single byte of HTTP is parsed. Rejected
+// sockets are closed on the spot; the close handler then reports -1. Every
+// connection is counted whatever the cap, so changing it later never
+// releases a count that was not taken. An upgrade also reports -1; the
+// WebSocket then keeps the count until its close (see xyra_app_ws).
+static void xyra_filter_connection(xyra_app_t* app, uWS::HttpResponse<XYRA_SSL> *res, int delta) {
+    xyra::IpKey key;
+    if (!xyra::IpKey::from_bytes(res->getRemoteAddress(), key)) return;
+
+    if (delta < 0) {
+        if (res != app->upgrading) app->connections_per_ip->release(key);
+        return;
+    }
+
+    bool reject = (app->connection_deny && app->connection_deny->contains(key))
+        || (app->connection_allow && !app->connection_allow->contains(key));
+    uint32_t open = app->connections_per_ip->acquire(key);
+    reject |= app->max_connections_per_ip && open > app->max_connections_per_ip;
+
+    if (reject) {
+        res->close();
+    }
+}
+
+static void xyra_install_connection_filter(xyra_app_t* app) {
+    if (app->connection_filter_installed) return;
+    app->connection_filter_installed = true;
+    if (!app->connections_per_ip) app->connections_per_ip = std::make_shared<xyra_connection_counts>();
+    app->app.filter([app](auto *res, int delta) {
+        xyra_filter_connection(app, res, delta);
+    });
+}
+
+void xyra_app_set_connection_filter(xyra_app_t* app, const xyra_ip_set_t* deny, const xyra_ip_set_t* allow, uint32_t max_per_ip) {
+    // The sets are copied so Python may free its handles afterwards.
+    app->connection_deny.reset(deny ? new xyra::IpSet(deny->set) : nullptr);
+    app->connection_allow.reset(allow ? new xyra::IpSet(allow->set) : nullptr);
+    app->max_connections_per_ip = max_per_ip;
+    xyra_install_connection_filter(app);
+}
+
+static void xyra_app_begin_shutdown(xyra_app_t* app, uint32_t timeout_ms);
+
+// The socket's descriptor. With ssl set uSockets returns the SSL* instead
+// (and reads TLS state a listen socket does not have), so always ask the
+// plain way: that is us_poll_fd in either build.
+static void *xyra_socket_fd(us_socket_t *socket) {
+    return us_socket_get_native_handle(0, socket);
+}
+
+// Failures are ignored: tuning is best effort and never stops a listen.
+static void xyra_set_socket_int(void *native_handle, int level, int name, int value) {
+    LIBUS_SOCKET_DESCRIPTOR fd = (LIBUS_SOCKET_DESCRIPTOR) (uintptr_t) native_handle;
+    setsockopt(fd, level, name, (const char *) &value, sizeof(value));
+}
+
+// Runs once a listen socket is bound; tcp is false for Unix domain sockets.
+static void xyra_tune_listen_handle(xyra_app_t* app, void *handle, bool tcp) {
+    const xyra_socket_options_t &opts = app->socket_options;
+
+    if (opts.recv_buffer) xyra_set_socket_int(handle, SOL_SOCKET, SO_RCVBUF, opts.recv_buffer);
+    if (opts.send_buffer) xyra_set_socket_int(handle, SOL_SOCKET, SO_SNDBUF, opts.send_buffer);
+    if (tcp) {
+#ifdef TCP_FASTOPEN
+        if (opts.tcp_fastopen) xyra_set_socket_int(handle, IPPROTO_TCP, TCP_FASTOPEN, opts.tcp_fastopen);
+#endif
+#ifdef TCP_DEFER_ACCEPT
+        if (opts.defer_accept) xyra_set_socket_int(handle, IPPROTO_TCP, TCP_DEFER_ACCEPT, opts.defer_accept);
+#endif
+    }
+    if (opts.backlog) {
+        // uSockets listens with a fixed backlog; listening again resizes it.
+        listen((LIBUS_SOCKET_DESCRIPTOR) (uintptr_t) handle, opts.backlog);
+    }
+}
+
+static void xyra_tune_listen_socket(xyra_app_t* app, us_listen_socket_t *listen_socket, bool tcp) {
+    // A listen socket starts with its us_socket_t.
+    xyra_tune_listen_handle(app, xyra_socket_fd((us_socket_t *) listen_socket), tcp);
+}
+
+void xyra_app_set_socket_options(xyra_app_t* app, const xyra_socket_options_t* options) {
+    app->socket_options = options ? *options : xyra_socket_options_t{};
+    if (app->socket_filter_installed || (!app->socket_options.tcp_nodelay && !app->socket_options.busy_poll)) return;
+
+    // Accepted sockets, from the same open handler as the connection filter,
+    // which may already have closed this one.
+    app->socket_filter_installed = true;
+    app->app.filter([app](auto *res, int delta) {
+        if (delta < 0 || us_socket_is_closed(XYRA_SSL, (us_socket_t *) res)) return;
+        const xyra_socket_options_t &opts = app->socket_options;
+        void *fd = xyra_socket_fd((us_socket_t *) res);
+        if (opts.tcp_nodelay) xyra_set_socket_int(fd, IPPROTO_TCP, TCP_NODELAY, opts.tcp_nodelay > 0);
+#ifdef SO_BUSY_POLL
+        if (opts.busy_poll) xyra_set_socket_int(fd, SOL_SOCKET, SO_BUSY_POLL, opts.busy_poll);
+#endif
+    });
+}
+
+bool xyra_tls_available(void) {
+    return XYRA_SSL;
+}
+
+#ifdef XYRA_TLS
+static int xyra_tls_passphrase(char *buf, int size, int, void *userdata) {
+    const std::string &passphrase = *(const std::string *) userdata;
+    int len = std::min<int>(size, (int) passphrase.size());
+    std::memcpy(buf, passphrase.data(), len);
+    return len;
+}
+#endif
+
+#ifdef XYRA_TLS
+// Loads a certificate chain and its key into a scratch context. uWS's
+// addServerName reports no errors, so SNI files are checked here first.
+static bool xyra_tls_check_files(const std::string &cert_file, const std::string &key_file, const std::string &passphrase) {
+    SSL_CTX *ctx = SSL_CTX_new(TLS_server_method());
+    if (!ctx) return false;
+    SSL_CTX_set_default_passwd_cb(ctx, xyra_tls_passphrase);
+    SSL_CTX_set_default_passwd_cb_userdata(ctx, (void *) &passphrase);
+    bool loaded = SSL_CTX_use_certificate_chain_file(ctx, cert_file.c_str()) == 1
+        && SSL_CTX_use_PrivateKey_file(ctx, key_file.c_str(), SSL_FILETYPE_PEM) == 1
+        && SSL_CTX_check_private_key(ctx) == 1;
+    SSL_CTX_free(ctx);
+    return loaded;
+}
+#endif
+
+// Loads tls into the app's default SSL_CTX (getNativeHandle on an SSLApp).
+// The context is created without a certificate, so this may run any time
+// before listening.
+static bool xyra_tls_apply(xyra_app_t* app, const XyraTlsConfig &tls) {
+#ifdef XYRA_TLS
+    SSL_CTX *ctx = (SSL_CTX *) app->app.getNativeHandle();
+    if (!ctx) return false;
+
+    SSL_CTX_set_default_passwd_cb(ctx, xyra_tls_passphrase);
+    SSL_CTX_set_default_passwd_cb_userdata(ctx, (void *) &tls.passphrase);
+    bool loaded = SSL_CTX_use_certificate_chain_file(ctx, tls.cert_file.c_str()) == 1
+        && SSL_CTX_use_PrivateKey_file(ctx, tls.key_file.c_str(), SSL_FILETYPE_PEM) == 1
+        && SSL_CTX_check_private_key(ctx) == 1;
+    SSL_CTX_set_default_passwd_cb_userdata(ctx, nullptr);
+    if (!loaded) return false;
+
+    if (!tls.ciphers.empty() && SSL_CTX_set_cipher_list(ctx, tls.ciphers.c_str()) != 1) return false;
+    if (!tls.ca_file.empty()) {
+        if (SSL_CTX_load_verify_locations(ctx, tls.ca_file.c_str(), nullptr) != 1) return false;
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, nullptr);
+    }
+
+    // Resumption. OpenSSL keeps using this (initial) context's cache and
+    // ticket keys after SNI switches certificates.
+    static const unsigned char session_id_context[] = "xyra";
+    SSL_CTX_set_session_id_context(ctx, session_id_context, sizeof(session_id_context) - 1);
+    if (tls.session_cache_size) {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_sess_set_cache_size(ctx, tls.session_cache_size);
+    } else {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+    }
+    if (tls.session_timeout) SSL_CTX_set_timeout(ctx, tls.session_timeout);
+    if (tls.session_tickets) {
+        SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+        if (SSL_CTX_set_tlsext_ticket_keys(ctx, (void *) tls.ticket_keys.data(), (long) tls.ticket_keys.size()) != 1) return false;
+    } else {
+        SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+    }
+
+    for (const auto &name : tls.server_names) {
+        uWS::SocketContextOptions options;
+        options.cert_file_name = name.cert_file.c_str();
+        options.key_file_name = name.key_file.c_str();
+        options.passphrase = name.passphrase.empty() ? nullptr : name.passphrase.c_str();
+        app->app.addServerName(name.hostname, options);
+    }
+    return true;
+#else
+    (void) app;
+    (void) tls;
+    return false;
+#endif
+}
+
+static std::string xyra_opt_string(const char *value) {
+    return value ? std::string(value) : std::string();
+}
+
+bool xyra_app_set_tls(xyra_app_t* app, const xyra_tls_options_t* options) {
+#ifdef XYRA_TLS
+    if (!options || !options->cert_file || !options->key_file) return false;
+    auto tls = std::make_shared<XyraTlsConfig>();
+    tls->cert_file = options->cert_file;
+    tls->key_file = options->key_file;
+    tls->passphrase = xyra_opt_string(options->passphrase);
+    tls->ca_file = xyra_opt_string(options->ca_file);
+    tls->ciphers = xyra_opt_string(options->ciphers);
+    tls->session_cache_size = options->session_cache_size;
+    tls->session_timeout = options->session_timeout;
+    tls->session_tickets = options->session_tickets;
+    if (app->tls) tls->server_names = app->tls->server_names;
+
+    if (tls->session_tickets) {
+        // OpenSSL wants 80 bytes, BoringSSL 48; NULL asks for the size.
+        SSL_CTX *ctx = (SSL_CTX *) app->app.getNativeHandle();
+        size_t key_len = ctx ? (size_t) SSL_CTX_get_tlsext_ticket_keys(ctx, nullptr, 0) : 0;
+        if (options->ticket_keys) {
+            if (options->ticket_keys_len != key_len) return false;
+            tls->ticket_keys.assign((const char *) options->ticket_keys, key_len);
+        } else {
+            tls->ticket_keys.resize(key_len);
+            if (RAND_bytes((unsigned char *) &tls->ticket_keys[0], (int) key_len) != 1) return false;
+        }
+    }
+
+    if (!xyra_tls_apply(app, *tls)) return false;
+    app->tls = std::move(tls);
+    return true;
+#else
+    (void) app;
+    (void) options;
+    return false;
+#endif
+}
+
+bool xyra_app_add_server_name(xyra_app_t* app, const char* hostname, const char* cert_file, const char* key_file, const char* passphrase) {
+    // SNI contexts hang off the default one, so certificates come first.
+    if (!XYRA_SSL || !app->tls || !hostname || !cert_file || !key_file) return false;
+    XyraTlsConfig::ServerName name{hostname, cert_file, key_file, xyra_opt_string(passphrase)};
+#ifdef XYRA_TLS
+    if (!xyra_tls_check_files(name.cert_file, name.key_file, name.passphrase)) return false;
+#endif
+    auto tls = std::make_shared<XyraTlsConfig>(*app->tls);
+    tls->server_names.push_back(std::move(name));
+
+    uWS::SocketContextOptions options;
+    options.cert_file_name = cert_file;
+    options.key_file_name = key_file;
+    options.passphrase = passphrase;
+    app->app.addServerName(hostname, options);
+    app->tls = std::move(tls);
+    return true;
+}
+
+void xyra_app_set_http_timeouts(xyra_app_t* app, const xyra_http_timeouts_t* timeouts) {
+    app->timeouts = timeouts ? *timeouts : xyra_http_timeouts_t{};
+    if (app->timeouts_filter_installed) return;
+
+    // uWS arms its 10 second idle timer on open, before filters run, so the
+    // header deadline replaces it. There is no hook for the first bytes of a
+    // later request, so keep-alive connections get idle_timeout instead (see
+    // xyra_res_finish). Upgrades and closes both report -1.
+    app->timeouts_filter_installed = true;
+    app->app.filter([app](auto *res, int delta) {
+        if (delta < 0) {
+            app->connection_requests.erase(res);
+            return;
+        }
+        us_socket_t *socket = (us_socket_t *) res;
+        if (app->timeouts.header_timeout && !us_socket_is_closed(XYRA_SSL, socket)) {
+            us_socket_timeout(XYRA_SSL, socket, app->timeouts.header_timeout);
+        }
+    });
+}
+
+// Counts a request on its connection; true once max_keepalive_requests is
+// reached, so the response closes the connection.
+static bool xyra_keepalive_spent(xyra_app_t* app, uWS::HttpResponse<XYRA_SSL> *res) {
+    uint32_t max = app->timeouts.max_keepalive_requests;
+    return max && ++app->connection_requests[res] >= max;
+}
+
+xyra_app_t* xyra_app_create_sibling(const xyra_app_t* parent) {
+    // Created on the calling thread, so uWS::Loop::get() hands the sibling
+    // that thread's own loop. Only configuration is copied: routes are
+    // registered by the caller and the per-IP counts start empty.
+    xyra_app_t* app = xyra_app_create();
+    app->rate_limiter = parent->rate_limiter;
+    app->limits = parent->limits;
+    app->max_requests = parent->max_requests;
+    app->recycle_drain_ms = parent->recycle_drain_ms;
+    xyra_app_set_socket_options(app, &parent->socket_options);
+    xyra_app_set_http_timeouts(app, &parent->timeouts);
+    if (parent->tls) {
+        // A sibling must not serve with a different (default) certificate.
+        if (!xyra_tls_apply(app, *parent->tls)) {
+            xyra_app_destroy(app);
+            return nullptr;
+        }
+        app->tls = parent->tls;
+    }
+
+    if (parent->connection_filter_installed) {
+        app->connection_deny.reset(parent->connection_deny ? new xyra::IpSet(*parent->connection_deny) : nullptr);
+        app->connection_allow.reset(parent->connection_allow ? new xyra::IpSet(*parent->connection_allow) : nullptr);
+        app->max_connections_per_ip = parent->max_connections_per_ip;
+        app->connections_per_ip = parent->connections_per_ip;
+        xyra_install_connection_filter(app);
+    }
+    if (parent->bus) xyra_join_bus(app, parent->bus);
+    return app;
+}
+
+// Counts a request towards max_requests; the one that reaches it is still
+// served, then the app drains and run() returns.
+static void xyra_count_request(xyra_app_t* app) {
+    if (app->max_requests && ++app->requests_served == app->max_requests) {
+        xyra_app_begin_shutdown(app, app->recycle_drain_ms);
+    }
 }
 
-// Route handlers macro
+void xyra_app_set_max_requests(xyra_app_t* app, uint64_t max_requests, uint32_t drain_timeout_ms) {
+    app->max_requests = max_requests;
+    app->recycle_drain_ms = drain_timeout_ms;
+    if (max_requests && app->requests_served >= max_requests) {
+        xyra_app_shutdown(app, drain_timeout_ms);
+    }
+}
+
+// Answers 429 straight from the uWS callback so a flood never reaches Python.
+// Mirrors the headers and body of the Python RateLimitMiddleware.
+static bool xyra_reject_rate_limited(xyra_app_t* app, uWS::HttpResponse<XYRA_SSL> *res) {
+    if (!app->rate_limiter) return false;
+
+    uint32_t retry_after = 0;
+    if (app->rate_limiter->allow(res->getRemoteAddress(), &retry_after, nullptr)) return false;
+
+    std::string body = "{\"error\":\"Too Many Requests\",\"message\":\"Rate limit exceeded. Please try again later.\",\"retry_after\":"
+        + std::to_string(retry_after) + "}";
+    res->writeStatus("429 Too Many Requests");
+    res->writeHeader("Retry-After", (uint64_t) retry_after);
+    res->writeHeader("X-RateLimit-Limit", (uint64_t) app->rate_limiter->limit());
+    res->writeHeader("X-RateLimit-Remaining", "0");
+    res->writeHeader("Content-Type", "application/json");
+    res->end(body);
+    return true;
+}
+
+void xyra_app_set_request_limits(xyra_app_t* app, const xyra_request_limits_t* limits) {
+    app->limits = limits ? *limits : xyra_request_limits_t{};
+}
+
+// Counts key[=value] fields the way xyra_parse_qsl splits them, stopping as
+// soon as the limit is exceeded.
+static uint32_t xyra_count_query_fields(std::string_view query, uint32_t stop_after) {
+    uint32_t fields = 0;
+    while (!query.empty() && fields <= stop_after) {
+        size_t amp = query.find('&');
+        if (amp != 0) fields++;
+        if (amp == std::string_view::npos) break;
+        query.remove_prefix(amp + 1);
+    }
+    return fields;
+}
+
+// Parses a Content-Length value; returns false if absent or malformed (uWS
+// rejects malformed framing itself, chunked bodies are capped in Python).
+static bool xyra_parse_content_length(std::string_view value, uint64_t &out) {
+    if (value.empty() || value.length() > 19) return false;
+    out = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') return false;
+        out = out * 10 + uint64_t(c - '0');
+    }
+    return true;
+}
+
+// Answers 414/431/413 straight from the uWS callback when a request breaks
+// the configured limits, closing the connection so an oversized body is never
+// read. The route's own body limit, if it has one, replaces the app's.
+static bool xyra_reject_over_limits(xyra_app_t* app, uWS::HttpResponse<XYRA_SSL> *res, uWS::HttpRequest *req, const xyra_route_options_t &route) {
+    const xyra_request_limits_t &limits = app->limits;
+
+    if (limits.max_url_length && req->getFullUrl().length() > limits.max_url_length) {
+        res->writeStatus("414 URI Too Long");
+        res->end("URI Too Long", true);
+        return true;
+    }
+    if (limits.max_query_fields && xyra_count_query_fields(req->getQuery(), limits.max_query_fields) > limits.max_query_fields) {
+        res->writeStatus("414 URI Too Long");
+        res->end("Too Many Query Parameters", true);
+        return true;
+    }
+
+    if (limits.max_headers || limits.max_header_bytes) {
+        uint32_t count = 0;
+        uint64_t bytes = 0;
+        for (auto [key, value] : *req) {
+            count++;
+            bytes += key.length() + value.length() + 4; // ": " and CRLF
+        }
+        if ((limits.max_headers && count > limits.max_headers)
+            || (limits.max_header_bytes && bytes > limits.max_header_bytes)) {
+            res->writeStatus("431 Request Header Fields Too Large");
+            res->end("Request Header Fields Too Large", true);
+            return true;
+        }
+    }
+
+    uint64_t max_body = route.has_max_body_size ? route.max_body_size : limits.max_body_size;
+    uint64_t content_length;
+    if (max_body && xyra_parse_content_length(req->getHeader("content-length"), content_length)
+        && content_length > max_body) {
+        res->writeStatus("413 Payload Too Large");
+        res->end("Payload Too Large", true);
+        return true;
+    }
+    return false;
+}
+
+// Route handlers macro. The route's options are copied into its handler.
 #define ROUTE_HANDLER(METHOD) \
-void xyra_app_##METHOD(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data) { \
-    reinterpret_cast<uWS::App*>(app)->METHOD(pattern, [handler, user_data](auto *res, auto *req) { \
+void xyra_app_##METHOD(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data, const xyra_route_options_t* options) { \
+    xyra_route_options_t route = options ? *options : xyra_route_options_t{}; \
+    app->app.METHOD(pattern, [app, handler, user_data, route](auto *res, auto *req) { \
+        if (xyra_reject_rate_limited(app, res)) return; \
+        if (xyra_reject_over_limits(app, res, req, route)) return; \
+        xyra_count_request(app); \
         xyra_request req_wrapper{req, false}; \
-        xyra_response res_wrapper{res, uWS::Loop::get(), std::make_shared<std::atomic<bool>>(false), std::string(res->getRemoteAddressAsText())}; \
+        xyra_response res_wrapper{res, uWS::Loop::get(), std::make_shared<std::atomic<bool>>(false), std::string(res->getRemoteAddressAsText()), app, xyra_keepalive_spent(app, res)}; \
         res->onAborted([&res_wrapper]() { \
             *res_wrapper.aborted = true; \
         }); \
@@ -235,53 +1046,132 @@ ROUTE_HANDLER(options)
 ROUTE_HANDLER(head)
 ROUTE_HANDLER(any)
 
+static_assert(int(XYRA_WS_SHARED_DECOMPRESSOR) == int(uWS::SHARED_DECOMPRESSOR), "xyra_ws_compression out of sync with uWS");
+static_assert(int(XYRA_WS_DEDICATED_COMPRESSOR_3KB) == int(uWS::DEDICATED_COMPRESSOR_3KB), "xyra_ws_compression out of sync with uWS");
+static_assert(int(XYRA_WS_DEDICATED_COMPRESSOR_256KB) == int(uWS::DEDICATED_COMPRESSOR_256KB), "xyra_ws_compression out of sync with uWS");
+static_assert(int(XYRA_WS_DEDICATED_DECOMPRESSOR_512B) == int(uWS::DEDICATED_DECOMPRESSOR_512B), "xyra_ws_compression out of sync with uWS");
+static_assert(int(XYRA_WS_DEDICATED_DECOMPRESSOR_32KB) == int(uWS::DEDICATED_DECOMPRESSOR_32KB), "xyra_ws_compression out of sync with uWS");
+
+// Completes a WebSocket handshake. The socket's connection count moves to
+// the WebSocket (see xyra_filter_connection) instead of being released.
+// True if the Sec-WebSocket-Extensions offer lists permessage-deflate,
+// which uWS always accepts when the route compresses.
+static bool xyra_offers_deflate(std::string_view extensions) {
+    while (!extensions.empty()) {
+        size_t end = extensions.find(',');
+        std::string_view offer = extensions.substr(0, end);
+        offer = offer.substr(0, offer.find(';'));
+        while (!offer.empty() && (offer.front() == ' ' || offer.front() == '\t')) offer.remove_prefix(1);
+        while (!offer.empty() && (offer.back() == ' ' || offer.back() == '\t')) offer.remove_suffix(1);
+        if (offer == "permessage-deflate") return true;
+        if (end == std::string_view::npos) break;
+        extensions.remove_prefix(end + 1);
+    }
+    return false;
+}
+
+static void xyra_ws_upgrade(xyra_app_t* app, uWS::HttpResponse<XYRA_SSL> *res, uWS::HttpRequest *req, us_socket_context_t *context, bool shared_compressor) {
+    std::string_view secWebSocketKey = req->getHeader("sec-websocket-key");
+    std::string_view secWebSocketProtocol = req->getHeader("sec-websocket-protocol");
+    std::string_view secWebSocketExtensions = req->getHeader("sec-websocket-extensions");
+
+    WebSocketData data;
+    data.shared_deflate = shared_compressor && xyra_offers_deflate(secWebSocketExtensions);
+    data.counted = app->connection_filter_installed
+        && xyra::IpKey::from_bytes(res->getRemoteAddress(), data.peer);
+    app->upgrading = res;
+    res->template upgrade<WebSocketData>(
+        std::move(data),
+        secWebSocketKey,
+        secWebSocketProtocol,
+        secWebSocketExtensions,
+        context
+    );
+    app->upgrading = nullptr;
+}
+
 void xyra_app_ws(xyra_app_t* app, const char* pattern,
                  xyra_ws_open_cb open_cb,
                  xyra_ws_message_cb message_cb,
                  xyra_ws_upgrade_cb upgrade_cb,
                  xyra_ws_close_cb close_cb,
+                 xyra_ws_drain_cb drain_cb,
+                 xyra_ws_batch_cb batch_cb,
+                 xyra_ws_message_cb control_cb,
+                 const xyra_ws_options_t* options,
                  void* user_data) {
 
-    uWS::App::WebSocketBehavior<WebSocketData> behavior;
+    xyra_uws_app::WebSocketBehavior<WebSocketData> behavior;
+
+    if (options) {
+        behavior.compression = static_cast<uWS::CompressOptions>(options->compression);
+        behavior.maxPayloadLength = options->max_payload_length;
+        behavior.idleTimeout = options->idle_timeout;
+        behavior.maxBackpressure = options->max_backpressure;
+        behavior.closeOnBackpressureLimit = options->close_on_backpressure_limit;
+        behavior.resetIdleTimeoutOnSend = options->reset_idle_timeout_on_send;
+        behavior.sendPingsAutomatically = options->send_pings_automatically;
+        behavior.maxLifetime = options->max_lifetime;
+    }
 
-    if (open_cb) {
-        behavior.open = [open_cb, user_data](auto *ws) {
-            xyra_websocket ws_wrapper{ws, ws->getUserData()->is_closed};
-            open_cb(&ws_wrapper, user_data);
+    behavior.open = [app, open_cb, user_data](auto *ws) {
+        ws->getUserData()->id = app->next_socket_id++;
+        auto *handle = new xyra_websocket();
+        handle->ws = ws;
+        handle->app = app;
+        handle->id = ws->getUserData()->id;
+        ws->getUserData()->handle = handle;
+        ws->getUserData()->last_activity_ms = app->now_ms;
+        app->sockets[ws->getUserData()->id] = ws;
+        if (open_cb) {
+            open_cb(ws->getUserData()->handle, user_data);
+        }
+    };
+
+    std::shared_ptr<xyra_ws_batcher> batcher;
+    if (batch_cb) {
+        batcher = std::make_shared<xyra_ws_batcher>();
+        batcher->cb = batch_cb;
+        batcher->user_data = user_data;
+        batcher->max_messages = options ? options->batch_max_messages : 0;
+        batcher->max_bytes = options ? options->batch_max_bytes : 0;
+        behavior.message = [app, batcher](auto *ws, std::string_view message, uWS::OpCode opCode) {
+            ws->getUserData()->last_activity_ms = app->now_ms;
+            batcher->push(ws, message, (int) opCode);
+        };
+        // Post handlers run once at the end of every loop iteration.
+        app->loop->addPostHandler(batcher.get(), [batcher](uWS::Loop *) {
+            batcher->flush();
+        });
+    } else if (message_cb) {
+        behavior.message = [app, message_cb, user_data](auto *ws, std::string_view message, uWS::OpCode opCode) {
+            ws->getUserData()->last_activity_ms = app->now_ms;
+            message_cb(ws->getUserData()->handle, message.data(), message.size(), (int)opCode, user_data);
         };
     }
 
-    if (message_cb) {
-        behavior.message = [message_cb, user_data](auto *ws, std::string_view message, uWS::OpCode opCode) {
-            xyra_websocket ws_wrapper{ws, ws->getUserData()->is_closed};
-            message_cb(&ws_wrapper, message.data(), message.size(), (int)opCode, user_data);
+    bool shared_compressor = (behavior.compression & 0xff) == uWS::SHARED_COMPRESSOR;
+    if (!upgrade_cb) {
+        behavior.upgrade = [app, shared_compressor](auto *res, auto *req, auto *context) {
+            xyra_ws_upgrade(app, res, req, context, shared_compressor);
         };
-    }
+    } else {
+        behavior.upgrade = [app, upgrade_cb, user_data, shared_compressor](auto *res, auto *req, auto *context) {
+            if (xyra_reject_rate_limited(app, res)) return;
+            if (xyra_reject_over_limits(app, res, req, xyra_route_options_t{})) return;
 
-    if (upgrade_cb) {
-        behavior.upgrade = [upgrade_cb, user_data](auto *res, auto *req, auto *context) {
             bool aborted = false;
             res->onAborted([&aborted]() { aborted = true; });
 
             xyra_request req_wrapper{req, false};
-            xyra_response res_wrapper{res, uWS::Loop::get(), std::make_shared<std::atomic<bool>>(false), std::string(res->getRemoteAddressAsText())};
+            xyra_response res_wrapper{res, uWS::Loop::get(), std::make_shared<std::atomic<bool>>(false), std::string(res->getRemoteAddressAsText()), app};
 
             bool ok = upgrade_cb(&res_wrapper, &req_wrapper, user_data);
 
             if (aborted) return;
 
             if (ok) {
-                std::string_view secWebSocketKey = req->getHeader("sec-websocket-key");
-                std::string_view secWebSocketProtocol = req->getHeader("sec-websocket-protocol");
-                std::string_view secWebSocketExtensions = req->getHeader("sec-websocket-extensions");
-
-                res->template upgrade<WebSocketData>(
-                    {},
-                    secWebSocketKey,
-                    secWebSocketProtocol,
-                    secWebSocketExtensions,
-                    context
-                );
+                xyra_ws_upgrade(app, res, req, context, shared_compressor);
             } else {
                 res->writeStatus("403 Forbidden");
                 res->end("Cross-Site WebSocket Hijacking blocked by Xyra");
@@ -289,25 +1179,244 @@ void xyra_app_ws(xyra_app_t* app, const char* pattern,
         };
     }
 
-    behavior.close = [close_cb, user_data](auto *ws, int code, std::string_view message) {
-        *ws->getUserData()->is_closed = true;
+    if (drain_cb) {
+        behavior.drain = [drain_cb, user_data](auto *ws) {
+            drain_cb(ws->getUserData()->handle, user_data);
+        };
+    }
+
+    behavior.ping = [app, control_cb, user_data](auto *ws, std::string_view message) {
+        ws->getUserData()->last_activity_ms = app->now_ms;
+        if (control_cb) control_cb(ws->getUserData()->handle, message.data(), message.size(), (int) uWS::OpCode::PING, user_data);
+    };
+    behavior.pong = [app, control_cb, user_data](auto *ws, std::string_view message) {
+        ws->getUserData()->last_activity_ms = app->now_ms;
+        if (control_cb) control_cb(ws->getUserData()->handle, message.data(), message.size(), (int) uWS::OpCode::PONG, user_data);
+    };
+
+    // Keeps the pub/sub bus's per-loop subscriber counts current so
+    // publishes skip loops with nobody listening.
+    behavior.subscription = [app](auto * /*ws*/, std::string_view topic, int new_count, int /*old_count*/) {
+        if (app->bus) app->bus->set_subscribers(app->bus_member, topic, new_count);
+    };
+
+    behavior.close = [app, close_cb, user_data, batcher](auto *ws, int code, std::string_view message) {
+        // Deliver what the socket sent before its close is reported.
+        if (batcher) batcher->flush();
+        WebSocketData *data = ws->getUserData();
+        if (data->counted) app->connections_per_ip->release(data->peer);
+        xyra_websocket *handle = data->handle;
+        handle->is_closed = true;
+        app->sockets.erase(data->id);
         if (close_cb) {
-            xyra_websocket ws_wrapper{ws, ws->getUserData()->is_closed};
-            close_cb(&ws_wrapper, code, message.data(), message.size(), user_data);
+            close_cb(handle, code, message.data(), message.size(), user_data);
         }
+        xyra_ws_release(handle);
     };
 
-    reinterpret_cast<uWS::App*>(app)->ws<WebSocketData>(pattern, std::move(behavior));
+    app->app.ws<WebSocketData>(pattern, std::move(behavior));
+}
+
+size_t xyra_app_ws_count(xyra_app_t* app) {
+    return app->sockets.size();
 }
 
 void xyra_app_listen(xyra_app_t* app, int port, xyra_listen_cb cb, void* user_data) {
-    reinterpret_cast<uWS::App*>(app)->listen(port, [cb, user_data](auto *listen_socket) {
+    xyra_app_listen_host(app, nullptr, port, XYRA_LISTEN_DEFAULT, cb, user_data);
+}
+
+static_assert(int(XYRA_LISTEN_DEFAULT) == LIBUS_LISTEN_DEFAULT, "xyra_listen_options out of sync with uSockets");
+static_assert(int(XYRA_LISTEN_EXCLUSIVE_PORT) == LIBUS_LISTEN_EXCLUSIVE_PORT, "xyra_listen_options out of sync with uSockets");
+
+void xyra_app_listen_host(xyra_app_t* app, const char* host, int port, int options, xyra_listen_cb cb, void* user_data) {
+    auto handler = [app, cb, user_data](auto *listen_socket) {
+        if (listen_socket) {
+            xyra_tune_listen_socket(app, listen_socket, true);
+            app->listen_sockets.push_back(listen_socket);
+        }
         cb(listen_socket != nullptr, user_data);
+    };
+    if (!host || !*host) {
+        app->app.listen(port, options, std::move(handler));
+        return;
+    }
+    app->app.listen(std::string(host), port, options, std::move(handler));
+}
+
+void xyra_app_listen_unix(xyra_app_t* app, const char* path, xyra_listen_cb cb, void* user_data) {
+    app->app.listen(LIBUS_LISTEN_DEFAULT, [app, cb, user_data](auto *listen_socket) {
+        if (listen_socket) {
+            xyra_tune_listen_socket(app, listen_socket, false);
+            app->listen_sockets.push_back(listen_socket);
+        }
+        cb(listen_socket != nullptr, user_data);
+    }, std::string(path));
+}
+
+#ifndef _WIN32
+// Pause after accept fails for lack of descriptors or memory
+static constexpr int XYRA_ACCEPT_BACKOFF_MS = 100;
+
+static void xyra_fd_acceptor_run(xyra_app_t* app, int listen_fd, int wake_fd) {
+    pollfd fds[2] = {{listen_fd, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+    bool backing_off = false;
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[1].revents) return;
+        // Non-blocking: another process sharing the socket may have taken
+        // the connection first.
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            int err = errno;
+            // Lost the race, or the client gave up while queued
+            if (err == EAGAIN || err == EWOULDBLOCK || err == EINTR || err == ECONNABORTED || err == EPROTO) continue;
+            // EMFILE, ENFILE, ENOBUFS, ENOMEM: the connection stays queued
+            // and poll keeps reporting it, so wait rather than spin. Only
+            // a stop request ends the wait early.
+            if (!backing_off) {
+                std::cerr << "xyra: accept failed (" << std::strerror(err) << "), retrying every "
+                          << XYRA_ACCEPT_BACKOFF_MS << " ms" << std::endl;
+                backing_off = true;
+            }
+            if (poll(&fds[1], 1, XYRA_ACCEPT_BACKOFF_MS) > 0) return;
+            continue;
+        }
+        backing_off = false;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        app->loop->defer([app, fd]() {
+            app->app.adoptSocket(fd);
+        });
+    }
+}
+#endif
+
+void xyra_app_listen_fd(xyra_app_t* app, int fd, xyra_listen_cb cb, void* user_data) {
+#ifdef _WIN32
+    (void) app; (void) fd;
+    cb(false, user_data);
+#else
+    int listen_fd = app->fd_acceptor ? -1 : fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    int wake[2];
+    if (listen_fd < 0 || pipe(wake) != 0) {
+        if (listen_fd >= 0) close(listen_fd);
+        cb(false, user_data);
+        return;
+    }
+    // Shared with the other holders of the socket, which accept the same way.
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+
+    sockaddr_storage addr{};
+    socklen_t addr_len = sizeof(addr);
+    getsockname(listen_fd, (sockaddr *) &addr, &addr_len);
+    xyra_tune_listen_handle(app, (void *) (uintptr_t) listen_fd, addr.ss_family != AF_UNIX);
+
+    auto acceptor = std::make_unique<xyra_fd_acceptor>();
+    acceptor->listen_fd = listen_fd;
+    acceptor->wake[0] = wake[0];
+    acceptor->wake[1] = wake[1];
+    acceptor->keepalive = us_create_timer((us_loop_t *) app->loop, 0, 0);
+    acceptor->thread = std::thread(xyra_fd_acceptor_run, app, listen_fd, wake[0]);
+    app->fd_acceptor = std::move(acceptor);
+    cb(true, user_data);
+#endif
+}
+
+// Loop thread; connections already handed to the loop are still adopted.
+static void xyra_stop_fd_acceptor(xyra_app_t* app) {
+#ifndef _WIN32
+    if (!app->fd_acceptor) return;
+    xyra_fd_acceptor &acceptor = *app->fd_acceptor;
+    (void) !write(acceptor.wake[1], "", 1);
+    acceptor.thread.join();
+    close(acceptor.listen_fd);
+    close(acceptor.wake[0]);
+    close(acceptor.wake[1]);
+    us_timer_close(acceptor.keepalive);
+    app->fd_acceptor.reset();
+#else
+    (void) app;
+#endif
+}
+
+// Runs on the loop thread. Once listen sockets, WebSockets and the last
+// in-flight responses are gone, nothing keeps the loop alive and run()
+// returns; the deadline timer is fallthrough so it does not hold it either.
+static void xyra_app_begin_shutdown(xyra_app_t* app, uint32_t timeout_ms) {
+    if (app->draining.exchange(true)) return;
+
+    for (us_listen_socket_t *listen_socket : app->listen_sockets) {
+        us_listen_socket_close(XYRA_SSL, listen_socket);
+    }
+    app->listen_sockets.clear();
+    xyra_stop_fd_acceptor(app);
+
+    // Copied first: each close handler erases its socket from the map.
+    std::vector<uWS::WebSocket<XYRA_SSL, true, WebSocketData> *> sockets;
+    sockets.reserve(app->sockets.size());
+    for (auto &entry : app->sockets) sockets.push_back(entry.second);
+    for (auto *ws : sockets) ws->end(1001, "Server shutting down");
+
+    if (timeout_ms) {
+        app->shutdown_timer = us_create_timer((us_loop_t *) app->loop, 1, sizeof(xyra_app_t *));
+        *(xyra_app_t **) us_timer_ext(app->shutdown_timer) = app;
+        us_timer_set(app->shutdown_timer, [](us_timer_t *timer) {
+            // Deadline: drop idle keep-alive and unfinished connections.
+            (*(xyra_app_t **) us_timer_ext(timer))->app.close();
+        }, (int) timeout_ms, 0);
+    }
+}
+
+void xyra_app_shutdown(xyra_app_t* app, uint32_t timeout_ms) {
+    if (std::this_thread::get_id() == app->loop_thread) {
+        xyra_app_begin_shutdown(app, timeout_ms);
+        return;
+    }
+    app->loop->defer([app, timeout_ms]() {
+        xyra_app_begin_shutdown(app, timeout_ms);
+    });
+}
+
+static void xyra_app_close_now(xyra_app_t* app) {
+    xyra_app_begin_shutdown(app, 0);
+    if (app->shutdown_timer) {
+        us_timer_close(app->shutdown_timer);
+        app->shutdown_timer = nullptr;
+    }
+    app->app.close();
+}
+
+void xyra_app_close(xyra_app_t* app) {
+    if (std::this_thread::get_id() == app->loop_thread) {
+        xyra_app_close_now(app);
+        return;
+    }
+    app->loop->defer([app]() {
+        xyra_app_close_now(app);
     });
 }
 
 void xyra_app_run(xyra_app_t* app) {
-    reinterpret_cast<uWS::App*>(app)->run();
+    app->app.run();
+}
+
+void xyra_app_publish(xyra_app_t* app, const char* topic, size_t topic_len, const char* message, size_t msg_len, int opcode, bool compress) {
+    if (app->bus) {
+        app->bus->publish(std::string_view(topic, topic_len), std::string_view(message, msg_len), opcode, compress);
+        return;
+    }
+    if (std::this_thread::get_id() == app->loop_thread) {
+        app->app.publish(std::string_view(topic, topic_len), std::string_view(message, msg_len), (uWS::OpCode) opcode, compress);
+        return;
+    }
+    // Off the loop thread: copy the payload and hand it to the loop's defer
+    // queue, which is the only thread-safe entry point into uWS.
+    app->loop->defer([app, topic = std::string(topic, topic_len), message = std::string(message, msg_len), opcode, compress]() {
+        app->app.publish(topic, message, (uWS::OpCode) opcode, compress);
+    });
 }
 
 // --- Request ---
@@ -386,26 +1495,45 @@ void xyra_res_write_header(xyra_response_t* res, const char* key, size_t key_len
     res->res->writeHeader(std::string_view(key, key_len), std::string_view(value, value_len));
 }
 
+// While draining, every response closes its connection so keep-alive
+// clients reconnect to another instance instead of holding this one open.
+static bool xyra_res_draining(xyra_response_t* res) {
+    return res->app && res->app->draining;
+}
+
+// Ends the response. A connection that stays open then has idle_timeout,
+// instead of uWS's fixed 10 seconds, to send its next request's headers;
+// uWS only resets the timer once a request is complete.
+static void xyra_res_finish(xyra_response_t* res, std::string_view data, bool close_connection) {
+    close_connection = close_connection || res->last_on_connection || xyra_res_draining(res);
+    res->res->end(data, close_connection);
+
+    us_socket_t *socket = (us_socket_t *) res->res;
+    if (!close_connection && res->app && res->app->timeouts.idle_timeout && !us_socket_is_closed(XYRA_SSL, socket)) {
+        us_socket_timeout(XYRA_SSL, socket, res->app->timeouts.idle_timeout);
+    }
+}
+
 void xyra_res_end(xyra_response_t* res, const char* data, size_t len, bool close_connection) {
     if (*res->aborted) return;
-    res->res->end(std::string_view(data, len), close_connection);
+    xyra_res_finish(res, std::string_view(data, len), close_connection);
 }
 
 void xyra_res_end_fast(xyra_response_t* res, const char* data, size_t len) {
     if (*res->aborted) return;
-    res->res->end(std::string_view(data, len));
+    xyra_res_finish(res, std::string_view(data, len), false);
 }
 
 void xyra_res_end_json(xyra_response_t* res, const char* data, size_t len) {
     if (*res->aborted) return;
     res->res->writeHeader("Content-Type", "application/json");
-    res->res->end(std::string_view(data, len));
+    xyra_res_finish(res, std::string_view(data, len), false);
 }
 
 void xyra_res_end_text(xyra_response_t* res, const char* data, size_t len) {
     if (*res->aborted) return;
     res->res->writeHeader("Content-Type", "text/plain; charset=utf-8");
-    res->res->end(std::string_view(data, len));
+    xyra_res_finish(res, std::string_view(data, len), false);
 }
 
 void xyra_res_close(xyra_response_t* res) {
@@ -420,7 +1548,13 @@ struct ResDataCtx {
 
 void xyra_res_on_data(xyra_response_t* res, xyra_res_on_data_cb cb, void* user_data) {
     if (*res->aborted) return;
-    res->res->onData([cb, user_data](std::string_view chunk, bool isEnd) {
+    // uWS stops the timer while a handler holds the request; body_timeout
+    // bounds each gap between chunks until the body is complete.
+    uint32_t body_timeout = res->app ? res->app->timeouts.body_timeout : 0;
+    us_socket_t *socket = (us_socket_t *) res->res;
+    if (body_timeout) us_socket_timeout(XYRA_SSL, socket, body_timeout);
+    res->res->onData([cb, user_data, socket, body_timeout](std::string_view chunk, bool isEnd) {
+        if (body_timeout) us_socket_timeout(XYRA_SSL, socket, isEnd ? 0 : body_timeout);
         cb(chunk.data(), chunk.length(), isEnd, user_data);
     });
 }
@@ -442,33 +1576,195 @@ size_t xyra_res_get_remote_address_bytes(xyra_response_t* res, const char** out_
 }
 
 // --- WebSocket ---
-void xyra_ws_send(xyra_websocket_t* ws, const char* message, size_t len, bool is_binary) {
-    if (*ws->is_closed) return;
-    ws->ws->send(std::string_view(message, len), is_binary ? uWS::OpCode::BINARY : uWS::OpCode::TEXT);
+static_assert(int(XYRA_WS_BACKPRESSURE) == int(uWS::WebSocket<XYRA_SSL, true, WebSocketData>::BACKPRESSURE), "xyra_ws_send_status out of sync with uWS");
+static_assert(int(XYRA_WS_SUCCESS) == int(uWS::WebSocket<XYRA_SSL, true, WebSocketData>::SUCCESS), "xyra_ws_send_status out of sync with uWS");
+static_assert(int(XYRA_WS_DROPPED) == int(uWS::WebSocket<XYRA_SSL, true, WebSocketData>::DROPPED), "xyra_ws_send_status out of sync with uWS");
+
+xyra_ws_send_status_t xyra_ws_send(xyra_websocket_t* ws, const char* message, size_t len, bool is_binary) {
+    if (ws->is_closed) return XYRA_WS_DROPPED;
+    auto status = ws->ws->send(std::string_view(message, len), is_binary ? uWS::OpCode::BINARY : uWS::OpCode::TEXT);
+    return static_cast<xyra_ws_send_status_t>(status);
+}
+
+xyra_prepared_message_t* xyra_prepared_message_create(const char* message, size_t len, int opcode, bool compress) {
+    auto *msg = new xyra_prepared_message{std::string(message, len), std::string(), opcode, compress};
+    // Like uWS, only non-empty data frames are compressed.
+    if (!compress || !len || len > UINT32_MAX || (opcode != 1 && opcode != 2)) return msg;
+
+    // Raw deflate with a 32KB window and a sync flush, minus the trailing
+    // 00 00 ff ff (RFC 7692, 7.2.1): what the shared compressor sends.
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) return msg;
+    std::string out(deflateBound(&stream, (uLong) len) + 16, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(message));
+    stream.avail_in = (uInt) len;
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = (uInt) out.size();
+    int rc = deflate(&stream, Z_SYNC_FLUSH);
+    size_t produced = out.size() - stream.avail_out;
+    deflateEnd(&stream);
+    if (rc == Z_OK && stream.avail_in == 0 && produced >= 4) {
+        out.resize(produced - 4);
+        msg->deflated = std::move(out);
+    }
+    return msg;
+}
+
+void xyra_prepared_message_destroy(xyra_prepared_message_t* msg) {
+    delete msg;
+}
+
+xyra_ws_send_status_t xyra_ws_send_prepared(xyra_websocket_t* ws, const xyra_prepared_message_t* msg) {
+    if (ws->is_closed) return XYRA_WS_DROPPED;
+
+    // Sockets on a SHARED_COMPRESSOR route all get the same deflated body.
+    // uWS puts the opcode byte into the frame header as given, so RSV1 (the
+    // permessage-deflate "compressed" bit) is set through it; send() still
+    // applies backpressure, the idle-timeout reset and the status.
+    if (!msg->deflated.empty() && ws->ws->getUserData()->shared_deflate) {
+        auto status = ws->ws->send(msg->deflated, (uWS::OpCode) (msg->opcode | 0x40), false);
+        return static_cast<xyra_ws_send_status_t>(status);
+    }
+
+    // Otherwise uWS frames the payload (and, on dedicated compressors,
+    // deflates it with the socket's own state).
+    auto status = ws->ws->send(msg->payload, (uWS::OpCode) msg->opcode, msg->compress);
+    return static_cast<xyra_ws_send_status_t>(status);
+}
+
+unsigned int xyra_ws_get_buffered_amount(xyra_websocket_t* ws) {
+    if (ws->is_closed) return 0;
+    return ws->ws->getBufferedAmount();
 }
 
 void xyra_ws_close(xyra_websocket_t* ws) {
-    if (*ws->is_closed) return;
+    if (ws->is_closed) return;
     ws->ws->close();
 }
 
+void xyra_ws_end(xyra_websocket_t* ws, int code, const char* message, size_t len) {
+    if (ws->is_closed) return;
+    ws->ws->end(code, std::string_view(message, len));
+}
+
 void xyra_ws_subscribe(xyra_websocket_t* ws, const char* topic, size_t len) {
-    if (*ws->is_closed) return;
+    if (ws->is_closed) return;
     ws->ws->subscribe(std::string_view(topic, len));
 }
 
 void xyra_ws_unsubscribe(xyra_websocket_t* ws, const char* topic, size_t len) {
-    if (*ws->is_closed) return;
+    if (ws->is_closed) return;
     ws->ws->unsubscribe(std::string_view(topic, len));
 }
 
+// WebSocket::publish only reaches subscribers on the socket's own loop (and
+// leaves the sender out); the other loops on the app's bus get it from there.
+static void xyra_ws_publish_all(xyra_app_t* app, uWS::WebSocket<XYRA_SSL, true, WebSocketData> *ws, std::string_view topic, std::string_view message, int opcode, bool compress) {
+    ws->publish(topic, message, (uWS::OpCode) opcode, compress);
+    if (app->bus) app->bus->publish(topic, message, opcode, compress, app->bus_member);
+}
+
 void xyra_ws_publish(xyra_websocket_t* ws, const char* topic, size_t topic_len, const char* message, size_t msg_len, bool is_binary, bool compress) {
-    if (*ws->is_closed) return;
-    ws->ws->publish(std::string_view(topic, topic_len), std::string_view(message, msg_len), is_binary ? uWS::OpCode::BINARY : uWS::OpCode::TEXT, compress);
+    if (ws->is_closed) return;
+    xyra_ws_publish_all(ws->app, ws->ws, std::string_view(topic, topic_len), std::string_view(message, msg_len),
+                        (int) (is_binary ? uWS::OpCode::BINARY : uWS::OpCode::TEXT), compress);
+}
+
+xyra_ws_send_status_t xyra_ws_send_fragment(xyra_websocket_t* ws, const char* data, size_t len, bool is_binary, bool first, bool last) {
+    if (ws->is_closed) return XYRA_WS_DROPPED;
+    std::string_view fragment(data, len);
+    uWS::OpCode opcode = is_binary ? uWS::OpCode::BINARY : uWS::OpCode::TEXT;
+    decltype(ws->ws->send(fragment)) status;
+    if (first && last) {
+        status = ws->ws->send(fragment, opcode);
+    } else if (first) {
+        status = ws->ws->sendFirstFragment(fragment, opcode);
+    } else if (last) {
+        status = ws->ws->sendLastFragment(fragment);
+    } else {
+        status = ws->ws->sendFragment(fragment);
+    }
+    return static_cast<xyra_ws_send_status_t>(status);
+}
+
+xyra_ws_send_status_t xyra_ws_ping(xyra_websocket_t* ws, const char* message, size_t len) {
+    if (ws->is_closed) return XYRA_WS_DROPPED;
+    auto status = ws->ws->send(std::string_view(message, len), uWS::OpCode::PING);
+    return static_cast<xyra_ws_send_status_t>(status);
+}
+
+uint64_t xyra_ws_get_idle_ms(xyra_websocket_t* ws) {
+    if (ws->is_closed) return 0;
+    // last_activity_ms is a loop time, so this may overstate by one iteration.
+    return xyra_steady_ms() - ws->ws->getUserData()->last_activity_ms;
+}
+
+uint64_t xyra_ws_get_id(xyra_websocket_t* ws) {
+    return ws->id;
+}
+
+void xyra_ws_set_user_data(xyra_websocket_t* ws, void* user_data) {
+    ws->user_data = user_data;
+}
+
+void* xyra_ws_get_user_data(xyra_websocket_t* ws) {
+    return ws->user_data;
+}
+
+bool xyra_ws_is_closed(xyra_websocket_t* ws) {
+    return ws->is_closed;
+}
+
+xyra_websocket_t* xyra_ws_retain(xyra_websocket_t* ws) {
+    ws->refs.fetch_add(1, std::memory_order_relaxed);
+    return ws;
+}
+
+void xyra_ws_release(xyra_websocket_t* ws) {
+    // May run on any thread (Python collects wrappers wherever it likes);
+    // the handle never touches uWS once closed.
+    if (ws->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete ws;
+}
+
+static void xyra_ws_run_op(xyra_app_t* app, uint64_t id, xyra_ws_op_t op, std::string_view topic, std::string_view message, int opcode, bool compress) {
+    auto it = app->sockets.find(id);
+    if (it == app->sockets.end()) return;
+    auto *ws = it->second;
+    switch (op) {
+    case XYRA_WS_OP_SEND:
+        ws->send(message, (uWS::OpCode) opcode, compress);
+        break;
+    case XYRA_WS_OP_PUBLISH:
+        xyra_ws_publish_all(app, ws, topic, message, opcode, compress);
+        break;
+    case XYRA_WS_OP_CLOSE:
+        ws->close();
+        break;
+    case XYRA_WS_OP_SUBSCRIBE:
+        ws->subscribe(topic);
+        break;
+    case XYRA_WS_OP_UNSUBSCRIBE:
+        ws->unsubscribe(topic);
+        break;
+    }
+}
+
+void xyra_ws_defer(xyra_app_t* app, uint64_t id, xyra_ws_op_t op, const char* topic, size_t topic_len, const char* message, size_t msg_len, int opcode, bool compress) {
+    std::string_view topic_view = topic ? std::string_view(topic, topic_len) : std::string_view();
+    std::string_view message_view = message ? std::string_view(message, msg_len) : std::string_view();
+    if (std::this_thread::get_id() == app->loop_thread) {
+        xyra_ws_run_op(app, id, op, topic_view, message_view, opcode, compress);
+        return;
+    }
+    // The id is only resolved on the loop thread, after any close that
+    // raced with this call has been processed.
+    app->loop->defer([app, id, op, topic = std::string(topic_view), message = std::string(message_view), opcode, compress]() {
+        xyra_ws_run_op(app, id, op, topic, message, opcode, compress);
+    });
 }
 
 size_t xyra_ws_get_remote_address_bytes(xyra_websocket_t* ws, const char** out_addr) {
-    if (*ws->is_closed) {
+    if (ws->is_closed) {
         *out_addr = nullptr;
         return 0;
     }
@@ -14,6 +14,9 @@ typedef struct xyra_app xyra_app_t;
 typedef struct xyra_request xyra_request_t;
 typedef struct xyra_response xyra_response_t;
 typedef struct xyra_websocket xyra_websocket_t;
+typedef struct xyra_ip_set xyra_ip_set_t;
+typedef struct xyra_pubsub xyra_pubsub_t;
+typedef struct xyra_prepared_message xyra_prepared_message_t;
 
 // Utility functions
 bool xyra_has_control_chars(const char* str, size_t len);
@@ -30,37 +33,287 @@ void xyra_format_cookie(
     char* out_buffer, size_t* out_len
 );
 
+// IP sets: IPv4/IPv6 prefix trie. Addresses are binary (4 or 16 bytes).
+xyra_ip_set_t* xyra_ip_set_create(void);
+void xyra_ip_set_destroy(xyra_ip_set_t* set);
+// False if addr is not 4 or 16 bytes or prefix_len is out of range for it.
+bool xyra_ip_set_add(xyra_ip_set_t* set, const char* addr, size_t addr_len, int prefix_len);
+bool xyra_ip_set_contains(const xyra_ip_set_t* set, const char* addr, size_t addr_len);
+// Resolves the client from an X-Forwarded-For (or RFC 7239 Forwarded) chain,
+// skipping trusted hops from the right. Writes the client address to out_addr
+// (16 bytes) and its length to out_addr_len, which is 0 if the client hop is
+// not a valid address (or the chain is empty). IPv4-mapped clients are
+// written as 4-byte IPv4. Returns the number of hops
+// peeled either way.
+int xyra_ip_set_resolve_forwarded(const xyra_ip_set_t* trusted, const char* chain, size_t len, bool rfc7239, char* out_addr, size_t* out_addr_len);
+
+// CSRF helpers, byte-compatible with CSRFMiddleware. Signed tokens are
+// "<token>.<hex HMAC-SHA256(secret, token)>"; masked tokens are unpadded
+// base64url(salt || token XOR salt) with a 32-byte salt.
+// Finds the cookie called name; out_value points into header. Duplicates
+// with different values count as absent.
+bool xyra_cookie_find(const char* header, size_t len, const char* name, size_t name_len, const char** out_value, size_t* out_len);
+// Writes the signed token to out (token_len + 65 bytes) and returns its length.
+size_t xyra_csrf_sign(const char* secret, size_t secret_len, const char* token, size_t token_len, char* out);
+// Constant-time signature check; on success out_token_len is the token prefix length.
+bool xyra_csrf_verify(const char* secret, size_t secret_len, const char* signed_token, size_t len, size_t* out_token_len);
+// Writes the masked token to out ((len + 32) * 4 / 3 + 1 bytes) and returns its length.
+size_t xyra_csrf_mask(const char* token, size_t len, const char* salt, char* out);
+// Writes the unmasked token to out (len bytes); returns 0 if not a masked token.
+size_t xyra_csrf_unmask(const char* masked, size_t len, char* out);
+
 // App functions
 xyra_app_t* xyra_app_create(void);
 void xyra_app_destroy(xyra_app_t* app);
 
+// uSockets event backend this library was linked with: "epoll", "kqueue",
+// "libuv" or "io_uring" (libxyra_uring, built with XYRA_IO_URING=ON).
+// xyra_event_backend_usable checks that the running kernel supports it; the
+// Python loader falls back to the epoll library when it does not.
+const char* xyra_event_backend(void);
+bool xyra_event_backend_usable(void);
+
+// Creates an app on the calling thread's event loop with parent's native
+// settings (rate limiter, shared; request limits, connection filter,
+// max_requests, pub/sub bus). Routes are not copied. One sibling per thread
+// lets a free-threaded interpreter serve from several loops in one process.
+// Returns NULL if parent's TLS settings cannot be applied to the new app.
+xyra_app_t* xyra_app_create_sibling(const xyra_app_t* parent);
+
+// Native rate limiting, checked in the uWS callback before Python is entered.
+// Passing requests == 0 disables it.
+void xyra_app_set_rate_limit(xyra_app_t* app, uint32_t requests, uint32_t window_seconds, size_t max_entries);
+
+// Accept-time connection filtering, applied before any HTTP parsing. Sockets
+// whose peer is in deny, outside allow, or over max_per_ip concurrent
+// connections are closed immediately. deny/allow may be NULL (sets are copied);
+// max_per_ip == 0 disables the cap. Upgraded WebSockets count until they
+// close, and siblings (xyra_app_create_sibling) share the counts.
+void xyra_app_set_connection_filter(xyra_app_t* app, const xyra_ip_set_t* deny, const xyra_ip_set_t* allow, uint32_t max_per_ip);
+
+// Request limits, checked in the uWS callback before Python is entered.
+// Violations are answered 414 (URL length, query fields), 431 (header count,
+// header bytes) or 413 (declared Content-Length). Zero disables a field;
+// NULL clears all limits.
+typedef struct xyra_request_limits {
+    uint32_t max_headers;
+    uint32_t max_header_bytes;
+    uint32_t max_url_length;
+    uint32_t max_query_fields;
+    uint64_t max_body_size;
+} xyra_request_limits_t;
+void xyra_app_set_request_limits(xyra_app_t* app, const xyra_request_limits_t* limits);
+// Settings of a single route (xyra_app_get etc.); NULL keeps the app's.
+// With has_max_body_size set, max_body_size replaces the app's limit for
+// this route, 0 disabling it.
+typedef struct xyra_route_options {
+    bool has_max_body_size;
+    uint64_t max_body_size;
+} xyra_route_options_t;
+
+// Socket tuning; zero leaves a field at the uSockets/OS default. backlog,
+// tcp_fastopen (queue length), defer_accept (seconds) and the buffer sizes
+// apply to listen sockets opened afterwards (accepted sockets inherit the
+// buffers). tcp_nodelay (1 on, -1 off; uSockets turns it on) and busy_poll
+// (SO_BUSY_POLL microseconds) apply to every accepted socket. Options the
+// platform lacks are skipped.
+typedef struct xyra_socket_options {
+    int32_t backlog;
+    int32_t tcp_fastopen;
+    int32_t defer_accept;
+    int32_t busy_poll;
+    int32_t recv_buffer;
+    int32_t send_buffer;
+    int32_t tcp_nodelay;
+} xyra_socket_options_t;
+void xyra_app_set_socket_options(xyra_app_t* app, const xyra_socket_options_t* options);
+
+// TLS termination, available in builds with XYRA_TLS=ON (see
+// xyra_tls_available); such a build serves HTTPS from every app. Files are
+// PEM. With ca_file set, clients must present a certificate it signed.
+// session_cache_size == 0 disables the server session cache. Ticket keys
+// (80 bytes with OpenSSL, 48 with BoringSSL) should be shared by every
+// process behind one port for tickets to resume everywhere; NULL generates
+// them. Returns false, leaving the app unchanged, if loading fails.
+typedef struct xyra_tls_options {
+    const char* cert_file;
+    const char* key_file;
+    const char* passphrase;
+    const char* ca_file;
+    const char* ciphers;
+    uint32_t session_cache_size;
+    uint32_t session_timeout;
+    bool session_tickets;
+    const unsigned char* ticket_keys;
+    size_t ticket_keys_len;
+} xyra_tls_options_t;
+bool xyra_tls_available(void);
+bool xyra_app_set_tls(xyra_app_t* app, const xyra_tls_options_t* options);
+// SNI: serves hostname (e.g. "api.example.com" or "*.example.com") with its
+// own certificate; other names get the default one. Call after
+// xyra_app_set_tls. False if the files do not load or do not match.
+bool xyra_app_add_server_name(xyra_app_t* app, const char* hostname, const char* cert_file, const char* key_file, const char* passphrase);
+
+// HTTP connection timeouts in seconds, enforced by uSockets timers (4 second
+// granularity, at most 900); zero keeps the default. idle_timeout bounds how
+// long a keep-alive connection waits for its next request (uWS: 10),
+// header_timeout how long a new connection may take to send its first
+// request's headers (uWS: 10), and body_timeout the gap between body chunks
+// while a handler reads the body (uWS: unbounded). header_timeout applies to
+// the first request only: uSockets does not report when a later one starts
+// arriving, so on a keep-alive connection idle_timeout bounds the wait and
+// the headers together (partial data does not reset it). After
+// max_keepalive_requests requests (0 = unlimited) the connection is closed.
+typedef struct xyra_http_timeouts {
+    uint32_t idle_timeout;
+    uint32_t header_timeout;
+    uint32_t body_timeout;
+    uint32_t max_keepalive_requests;
+} xyra_http_timeouts_t;
+void xyra_app_set_http_timeouts(xyra_app_t* app, const xyra_http_timeouts_t* timeouts);
+
 // Callbacks
 typedef void (*xyra_route_handler_cb)(xyra_response_t* res, xyra_request_t* req, void* user_data);
 
-void xyra_app_get(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data);
-void xyra_app_post(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data);
-void xyra_app_put(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data);
-void xyra_app_del(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data);
-void xyra_app_patch(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data);
-void xyra_app_options(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data);
-void xyra_app_head(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data);
-void xyra_app_any(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data);
+void xyra_app_get(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data, const xyra_route_options_t* options);
+void xyra_app_post(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data, const xyra_route_options_t* options);
+void xyra_app_put(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data, const xyra_route_options_t* options);
+void xyra_app_del(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data, const xyra_route_options_t* options);
+void xyra_app_patch(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data, const xyra_route_options_t* options);
+void xyra_app_options(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data, const xyra_route_options_t* options);
+void xyra_app_head(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data, const xyra_route_options_t* options);
+void xyra_app_any(xyra_app_t* app, const char* pattern, xyra_route_handler_cb handler, void* user_data, const xyra_route_options_t* options);
 
 typedef void (*xyra_ws_open_cb)(xyra_websocket_t* ws, void* user_data);
 typedef void (*xyra_ws_message_cb)(xyra_websocket_t* ws, const char* message, size_t len, int opCode, void* user_data);
 typedef bool (*xyra_ws_upgrade_cb)(xyra_response_t* res, xyra_request_t* req, void* user_data);
 typedef void (*xyra_ws_close_cb)(xyra_websocket_t* ws, int code, const char* message, size_t len, void* user_data);
+// Called when a socket's send buffer has drained below maxBackpressure.
+typedef void (*xyra_ws_drain_cb)(xyra_websocket_t* ws, void* user_data);
+
+// permessage-deflate settings (same values as uWS::CompressOptions). One
+// compressor and one decompressor value may be OR'ed together.
+typedef enum xyra_ws_compression {
+    XYRA_WS_COMPRESSION_DISABLED = 0,
+    XYRA_WS_SHARED_COMPRESSOR = 1,
+    XYRA_WS_SHARED_DECOMPRESSOR = 256,
+    XYRA_WS_DEDICATED_COMPRESSOR_3KB = 145,
+    XYRA_WS_DEDICATED_COMPRESSOR_4KB = 146,
+    XYRA_WS_DEDICATED_COMPRESSOR_8KB = 163,
+    XYRA_WS_DEDICATED_COMPRESSOR_16KB = 180,
+    XYRA_WS_DEDICATED_COMPRESSOR_32KB = 197,
+    XYRA_WS_DEDICATED_COMPRESSOR_64KB = 214,
+    XYRA_WS_DEDICATED_COMPRESSOR_128KB = 231,
+    XYRA_WS_DEDICATED_COMPRESSOR_256KB = 248,
+    XYRA_WS_DEDICATED_DECOMPRESSOR_512B = 2304,
+    XYRA_WS_DEDICATED_DECOMPRESSOR_1KB = 2560,
+    XYRA_WS_DEDICATED_DECOMPRESSOR_2KB = 2816,
+    XYRA_WS_DEDICATED_DECOMPRESSOR_4KB = 3072,
+    XYRA_WS_DEDICATED_DECOMPRESSOR_8KB = 3328,
+    XYRA_WS_DEDICATED_DECOMPRESSOR_16KB = 3584,
+    XYRA_WS_DEDICATED_DECOMPRESSOR_32KB = 3840
+} xyra_ws_compression_t;
+
+// Per-route WebSocket behaviour. All fields are applied as given; pass NULL
+// to xyra_app_ws for the uWS defaults (no compression, 16 KB payloads, 120 s
+// idle timeout, 64 KB backpressure, automatic pings, no lifetime cap, no
+// batching). When batch_cb is given it replaces message_cb.
+//
+// Heartbeats are native: a socket silent for idle_timeout seconds is sent a
+// ping (send_pings_automatically) and closed if the next period passes
+// without traffic, with no Python involved.
+typedef struct xyra_ws_options {
+    uint32_t compression;
+    uint32_t max_payload_length;
+    uint16_t idle_timeout;
+    uint32_t max_backpressure;
+    bool close_on_backpressure_limit;
+    bool reset_idle_timeout_on_send;
+    bool send_pings_automatically;
+    // Batched delivery (with a batch_cb): flush early after this many
+    // messages / bytes. 0 leaves only the end-of-loop-iteration flush.
+    uint32_t batch_max_messages;
+    uint32_t batch_max_bytes;
+    // Close connections after this many minutes regardless of activity (0 = never).
+    uint16_t max_lifetime;
+} xyra_ws_options_t;
+
+// One message of a batch. ws and message are only valid during the callback.
+typedef struct xyra_ws_batch_entry {
+    xyra_websocket_t* ws;
+    const char* message;
+    size_t len;
+    int opcode;
+} xyra_ws_batch_entry_t;
+// Receives every message a route got during one loop iteration (across all
+// its sockets) in arrival order. Pending messages are flushed before any
+// close callback for the route. If the callback closes a socket, the close
+// callback runs at once and the socket's remaining entries report
+// xyra_ws_is_closed; they are not delivered again.
+typedef void (*xyra_ws_batch_cb)(const xyra_ws_batch_entry_t* entries, size_t count, void* user_data);
 
 void xyra_app_ws(xyra_app_t* app, const char* pattern,
                  xyra_ws_open_cb open_cb,
                  xyra_ws_message_cb message_cb,
                  xyra_ws_upgrade_cb upgrade_cb,
                  xyra_ws_close_cb close_cb,
+                 xyra_ws_drain_cb drain_cb,
+                 xyra_ws_batch_cb batch_cb,
+                 xyra_ws_message_cb control_cb,
+                 const xyra_ws_options_t* options,
                  void* user_data);
+// control_cb (optional) reports received pings (opcode 9) and pongs
+// (opcode 10); uWS answers pings itself either way.
+
+// Number of open WebSockets across the app's routes.
+size_t xyra_app_ws_count(xyra_app_t* app);
 
 typedef void (*xyra_listen_cb)(bool success, void* user_data);
 void xyra_app_listen(xyra_app_t* app, int port, xyra_listen_cb cb, void* user_data);
+// Same as LIBUS_LISTEN_* (EXCLUSIVE_PORT fails instead of sharing the port
+// with another process).
+typedef enum xyra_listen_options {
+    XYRA_LISTEN_DEFAULT = 0,
+    XYRA_LISTEN_EXCLUSIVE_PORT = 1
+} xyra_listen_options_t;
+// Binds host:port, where host is an IPv4/IPv6 address or name; NULL or ""
+// binds every interface like xyra_app_listen.
+void xyra_app_listen_host(xyra_app_t* app, const char* host, int port, int options, xyra_listen_cb cb, void* user_data);
+// Listens on a Unix domain socket; path must not exist yet.
+void xyra_app_listen_unix(xyra_app_t* app, const char* path, xyra_listen_cb cb, void* user_data);
+// Accepts from an already listening socket (TCP or Unix), e.g. one
+// inherited from the process that started this one. The socket is
+// duplicated, so the caller may close fd; it is set non-blocking and may be
+// shared with other processes. One per app; not supported on Windows.
+void xyra_app_listen_fd(xyra_app_t* app, int fd, xyra_listen_cb cb, void* user_data);
 void xyra_app_run(xyra_app_t* app);
+// Graceful shutdown, callable from any thread: closes the listen sockets,
+// sends WebSockets a 1001 close, and lets in-flight requests finish (their
+// connections close afterwards instead of staying keep-alive). xyra_app_run
+// returns once no connections remain; after timeout_ms (0 = no deadline)
+// whatever is still open is closed.
+void xyra_app_shutdown(xyra_app_t* app, uint32_t timeout_ms);
+// Ends a shutdown (or starts one) without waiting: every connection is
+// closed now. Callable from any thread.
+void xyra_app_close(xyra_app_t* app);
+// Worker recycling: once max_requests HTTP requests (0 = unlimited) have
+// been dispatched, the app shuts down as with xyra_app_shutdown(app,
+// drain_timeout_ms) so a supervisor can replace the process.
+void xyra_app_set_max_requests(xyra_app_t* app, uint64_t max_requests, uint32_t drain_timeout_ms);
+// Publishes to every WebSocket subscribed to topic (opcode 1 text, 2 binary).
+// Safe to call from any thread; off the loop thread the message is copied
+// and delivered on the next loop iteration.
+void xyra_app_publish(xyra_app_t* app, const char* topic, size_t topic_len, const char* message, size_t msg_len, int opcode, bool compress);
+
+// Cross-loop pub/sub. Apps running on different threads join one bus; a
+// publish is copied once and queued to every joined loop that has
+// subscribers for the topic. Once joined, xyra_app_publish goes through the
+// bus, and so do xyra_ws_publish and deferred publishes (the sender is still
+// left out on its own loop). Returns the number of loops the message was queued for.
+xyra_pubsub_t* xyra_pubsub_create(void);
+void xyra_pubsub_destroy(xyra_pubsub_t* bus);
+size_t xyra_pubsub_publish(xyra_pubsub_t* bus, const char* topic, size_t topic_len, const char* message, size_t msg_len, int opcode, bool compress);
+void xyra_app_join_pubsub(xyra_app_t* app, xyra_pubsub_t* bus);
 
 // Request functions
 size_t xyra_req_get_url(xyra_request_t* req, const char** out_url);
@@ -91,13 +344,78 @@ void xyra_res_on_aborted(xyra_response_t* res, xyra_res_on_aborted_cb cb, void*
 size_t xyra_res_get_remote_address_bytes(xyra_response_t* res, const char** out_addr);
 
 // WebSocket functions
-void xyra_ws_send(xyra_websocket_t* ws, const char* message, size_t len, bool is_binary);
+// A xyra_websocket_t* is valid until its close callback returns. To use it
+// longer, take a reference with xyra_ws_retain and drop it with
+// xyra_ws_release; after close every call on it is a no-op (sends report
+// XYRA_WS_DROPPED), except xyra_ws_get_id and the user data slot.
+xyra_websocket_t* xyra_ws_retain(xyra_websocket_t* ws);
+void xyra_ws_release(xyra_websocket_t* ws);
+// True once the socket's close callback has started (a batch entry may
+// refer to a socket the batch handler closed).
+bool xyra_ws_is_closed(xyra_websocket_t* ws);
+// Same values as uWS::WebSocket::SendStatus. BACKPRESSURE means the message
+// was queued behind earlier data; DROPPED that it was discarded (socket
+// closed, or over maxBackpressure with closeOnBackpressureLimit).
+typedef enum xyra_ws_send_status {
+    XYRA_WS_BACKPRESSURE = 0,
+    XYRA_WS_SUCCESS = 1,
+    XYRA_WS_DROPPED = 2
+} xyra_ws_send_status_t;
+
+xyra_ws_send_status_t xyra_ws_send(xyra_websocket_t* ws, const char* message, size_t len, bool is_binary);
+// Streams one message as several frames: the first call (first = true) sets
+// the opcode, the last (last = true) finishes the message; with both set
+// it is a plain send. No other message may be sent on the socket in between.
+xyra_ws_send_status_t xyra_ws_send_fragment(xyra_websocket_t* ws, const char* data, size_t len, bool is_binary, bool first, bool last);
+// Sends a ping frame (payload up to 125 bytes); the client's pong is
+// reported to control_cb.
+xyra_ws_send_status_t xyra_ws_ping(xyra_websocket_t* ws, const char* message, size_t len);
+// Milliseconds since the socket last received a message, ping or pong (or
+// opened), at event-loop-iteration resolution.
+uint64_t xyra_ws_get_idle_ms(xyra_websocket_t* ws);
+// Bytes queued for the socket but not yet written; 0 once closed.
+unsigned int xyra_ws_get_buffered_amount(xyra_websocket_t* ws);
+
+// Prepared messages: the payload is encoded once and each send copies it
+// into the recipient's socket buffer through WebSocket::send. With compress
+// set it is also deflated once; sockets on SHARED_COMPRESSOR routes get that
+// frame, dedicated compressors still deflate per socket.
+xyra_prepared_message_t* xyra_prepared_message_create(const char* message, size_t len, int opcode, bool compress);
+void xyra_prepared_message_destroy(xyra_prepared_message_t* msg);
+xyra_ws_send_status_t xyra_ws_send_prepared(xyra_websocket_t* ws, const xyra_prepared_message_t* msg);
 void xyra_ws_close(xyra_websocket_t* ws);
+// Sends a close frame with code and reason, then closes the socket.
+void xyra_ws_end(xyra_websocket_t* ws, int code, const char* message, size_t len);
 void xyra_ws_subscribe(xyra_websocket_t* ws, const char* topic, size_t len);
 void xyra_ws_unsubscribe(xyra_websocket_t* ws, const char* topic, size_t len);
 void xyra_ws_publish(xyra_websocket_t* ws, const char* topic, size_t topic_len, const char* message, size_t msg_len, bool is_binary, bool compress);
 size_t xyra_ws_get_remote_address_bytes(xyra_websocket_t* ws, const char** out_addr);
 
+// Connection ids are unique per app and never reused, so work queued for a
+// socket that has since closed is recognised and dropped.
+uint64_t xyra_ws_get_id(xyra_websocket_t* ws);
+
+// One pointer-sized slot per socket, owned by the binding (xyra keeps the
+// Python state object there). NULL until set; the caller must release
+// whatever it stored from the close callback.
+void xyra_ws_set_user_data(xyra_websocket_t* ws, void* user_data);
+void* xyra_ws_get_user_data(xyra_websocket_t* ws);
+
+// Socket operations for code running off the loop thread (async handlers),
+// addressed by connection id instead of a xyra_websocket_t*. Payloads are
+// copied and the operation runs on the app's loop; it is a no-op if the id
+// no longer names an open socket. opcode and compress apply to SEND and
+// PUBLISH, topic to PUBLISH, SUBSCRIBE and UNSUBSCRIBE.
+typedef enum xyra_ws_op {
+    XYRA_WS_OP_SEND = 0,
+    XYRA_WS_OP_PUBLISH = 1,
+    XYRA_WS_OP_CLOSE = 2,
+    XYRA_WS_OP_SUBSCRIBE = 3,
+    XYRA_WS_OP_UNSUBSCRIBE = 4
+} xyra_ws_op_t;
+
+void xyra_ws_defer(xyra_app_t* app, uint64_t id, xyra_ws_op_t op, const char* topic, size_t topic_len, const char* message, size_t msg_len, int opcode, bool compress);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,3 +1,4 @@
+import ctypes.util
 import glob
 import os
 import platform
@@ -30,6 +31,15 @@ ffi.cdef("\n".join(filtered_lines))
 # (This ensures all USOCKETS definitions and system libs are properly handled)
 
 extra_libs = ["z"]
+# XYRA_IO_URING=1 also wraps libxyra_uring as xyra._libxyra_uring. Matches the
+# CMake check: without liburing only the epoll library is built.
+IO_URING = (
+    platform.system() == "Linux"
+    and os.environ.get("XYRA_IO_URING") == "1"
+    and ctypes.util.find_library("uring") is not None
+)
+if os.environ.get("XYRA_TLS") == "1":
+    extra_libs.extend(["ssl", "crypto"])
 if platform.system() == "Windows":
     extra_libs.extend(["libuv", "advapi32", "iphlpapi", "userenv", "ws2_32", "psapi"])
 
@@ -82,8 +92,24 @@ ffi.set_source(
     libraries=cffi_libs + extra_libs
 )
 
+ffi_uring = None
+if IO_URING:
+    ffi_uring = FFI()
+    ffi_uring.cdef("\n".join(filtered_lines))
+    ffi_uring.set_source(
+        "xyra._libxyra_uring",
+        '#include "c_api.h"',
+        include_dirs=[
+            os.path.abspath("xyra/native")
+        ],
+        library_dirs=library_dirs,
+        libraries=["xyra_uring", "stdc++"] + extra_libs + ["uring"]
+    )
+
 def build_cffi(output_path):
     ffi.compile(tmpdir=os.path.dirname(output_path))
+    if ffi_uring is not None:
+        ffi_uring.compile(tmpdir=os.path.dirname(output_path))
 
 if __name__ == "__main__":
     build_cffi("xyra_cffi.c")
@@ -0,0 +1,287 @@
+#ifndef XYRA_CSRF_H
+#define XYRA_CSRF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace xyra {
+
+// Minimal SHA-256 (FIPS 180-4). The native layer is built without OpenSSL,
+// and HMAC over short CSRF tokens is all it is used for.
+class Sha256 {
+public:
+    static constexpr size_t DIGEST_SIZE = 32;
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    Sha256() { reset(); }
+
+    void reset() {
+        static const uint32_t init[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+        };
+        std::memcpy(state_, init, sizeof(state_));
+        length_ = 0;
+        buffered_ = 0;
+    }
+
+    void update(const unsigned char *data, size_t len) {
+        length_ += len;
+        if (buffered_) {
+            size_t take = BLOCK_SIZE - buffered_ < len ? BLOCK_SIZE - buffered_ : len;
+            std::memcpy(buffer_ + buffered_, data, take);
+            buffered_ += take;
+            data += take;
+            len -= take;
+            if (buffered_ < BLOCK_SIZE) return;
+            compress(buffer_);
+            buffered_ = 0;
+        }
+        for (; len >= BLOCK_SIZE; data += BLOCK_SIZE, len -= BLOCK_SIZE) compress(data);
+        std::memcpy(buffer_, data, len);
+        buffered_ = len;
+    }
+
+    void update(std::string_view data) {
+        update(reinterpret_cast<const unsigned char *>(data.data()), data.length());
+    }
+
+    void finish(unsigned char out[DIGEST_SIZE]) {
+        uint64_t bits = length_ * 8;
+        static const unsigned char pad[BLOCK_SIZE] = {0x80};
+        update(pad, buffered_ < 56 ? 56 - buffered_ : 120 - buffered_);
+        unsigned char len_be[8];
+        for (int i = 7; i >= 0; i--, bits >>= 8) len_be[i] = (unsigned char) bits;
+        update(len_be, 8);
+        for (int i = 0; i < 8; i++) {
+            out[i * 4] = (unsigned char) (state_[i] >> 24);
+            out[i * 4 + 1] = (unsigned char) (state_[i] >> 16);
+            out[i * 4 + 2] = (unsigned char) (state_[i] >> 8);
+            out[i * 4 + 3] = (unsigned char) state_[i];
+        }
+    }
+
+private:
+    static uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    void compress(const unsigned char *block) {
+        static const uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+        };
+
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16)
+                | (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+        uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state_[0] += a; state_[1] += b; state_[2] += c; state_[3] += d;
+        state_[4] += e; state_[5] += f; state_[6] += g; state_[7] += h;
+    }
+
+    uint32_t state_[8];
+    uint64_t length_;
+    unsigned char buffer_[BLOCK_SIZE];
+    size_t buffered_;
+};
+
+inline void hmac_sha256(std::string_view key, std::string_view message, unsigned char out[Sha256::DIGEST_SIZE]) {
+    unsigned char block[Sha256::BLOCK_SIZE] = {0};
+    if (key.length() > Sha256::BLOCK_SIZE) {
+        Sha256 kh;
+        kh.update(key);
+        kh.finish(block);
+    } else {
+        std::memcpy(block, key.data(), key.length());
+    }
+
+    unsigned char pad[Sha256::BLOCK_SIZE];
+    Sha256 inner;
+    for (size_t i = 0; i < Sha256::BLOCK_SIZE; i++) pad[i] = block[i] ^ 0x36;
+    inner.update(pad, sizeof(pad));
+    inner.update(message);
+    unsigned char inner_digest[Sha256::DIGEST_SIZE];
+    inner.finish(inner_digest);
+
+    Sha256 outer;
+    for (size_t i = 0; i < Sha256::BLOCK_SIZE; i++) pad[i] = block[i] ^ 0x5c;
+    outer.update(pad, sizeof(pad));
+    outer.update(inner_digest, sizeof(inner_digest));
+    outer.finish(out);
+}
+
+// Compares without an early exit so timing does not reveal the matching
+// prefix. Lengths are not secret and are checked up front.
+inline bool constant_time_equals(std::string_view a, std::string_view b) {
+    if (a.length() != b.length()) return false;
+    unsigned char diff = 0;
+    for (size_t i = 0; i < a.length(); i++) diff |= (unsigned char) (a[i] ^ b[i]);
+    return diff == 0;
+}
+
+// Signed CSRF tokens are "<token>.<hex HMAC-SHA256(secret, token)>", the
+// format CSRFMiddleware has always issued.
+constexpr size_t CSRF_SIGNATURE_HEX = Sha256::DIGEST_SIZE * 2;
+constexpr size_t CSRF_SALT_SIZE = 32;
+
+inline void csrf_signature(std::string_view secret, std::string_view token, char out[CSRF_SIGNATURE_HEX]) {
+    static const char hex[] = "0123456789abcdef";
+    unsigned char mac[Sha256::DIGEST_SIZE];
+    hmac_sha256(secret, token, mac);
+    for (size_t i = 0; i < Sha256::DIGEST_SIZE; i++) {
+        out[i * 2] = hex[mac[i] >> 4];
+        out[i * 2 + 1] = hex[mac[i] & 0xf];
+    }
+}
+
+// Returns true and sets token_len when the signature after the last '.'
+// matches.
+inline bool csrf_verify(std::string_view secret, std::string_view signed_token, size_t &token_len) {
+    size_t dot = signed_token.rfind('.');
+    if (dot == std::string_view::npos) return false;
+
+    char expected[CSRF_SIGNATURE_HEX];
+    csrf_signature(secret, signed_token.substr(0, dot), expected);
+    if (!constant_time_equals(signed_token.substr(dot + 1), std::string_view(expected, sizeof(expected)))) {
+        return false;
+    }
+    token_len = dot;
+    return true;
+}
+
+inline size_t base64url_encoded_size(size_t len) { return (len * 4 + 2) / 3; }
+
+// Unpadded URL-safe base64.
+inline size_t base64url_encode(const unsigned char *data, size_t len, char *out) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    size_t o = 0, i = 0;
+    for (; i + 2 < len; i += 3) {
+        uint32_t v = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+        out[o++] = alphabet[v >> 18];
+        out[o++] = alphabet[(v >> 12) & 63];
+        out[o++] = alphabet[(v >> 6) & 63];
+        out[o++] = alphabet[v & 63];
+    }
+    if (i < len) {
+        uint32_t v = uint32_t(data[i]) << 16;
+        if (i + 1 < len) v |= uint32_t(data[i + 1]) << 8;
+        out[o++] = alphabet[v >> 18];
+        out[o++] = alphabet[(v >> 12) & 63];
+        if (i + 1 < len) out[o++] = alphabet[(v >> 6) & 63];
+    }
+    return o;
+}
+
+// Decodes URL-safe base64 with optional padding into out (at least
+// len * 3 / 4 bytes). Returns false on any other character.
+inline bool base64url_decode(std::string_view in, unsigned char *out, size_t &out_len) {
+    while (!in.empty() && in.back() == '=') in.remove_suffix(1);
+    if (in.length() % 4 == 1) return false;
+
+    uint32_t acc = 0;
+    int bits = 0;
+    out_len = 0;
+    for (char c : in) {
+        int v;
+        if (c >= 'A' && c <= 'Z') v = c - 'A';
+        else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') v = c - '0' + 52;
+        else if (c == '-') v = 62;
+        else if (c == '_') v = 63;
+        else return false;
+
+        acc = (acc << 6) | uint32_t(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out[out_len++] = (unsigned char) (acc >> bits);
+        }
+    }
+    return true;
+}
+
+// BREACH masking: base64url(salt || token XOR salt), salt repeating.
+inline size_t csrf_mask(std::string_view token, const unsigned char salt[CSRF_SALT_SIZE], unsigned char *scratch, char *out) {
+    std::memcpy(scratch, salt, CSRF_SALT_SIZE);
+    for (size_t i = 0; i < token.length(); i++) {
+        scratch[CSRF_SALT_SIZE + i] = (unsigned char) token[i] ^ salt[i % CSRF_SALT_SIZE];
+    }
+    return base64url_encode(scratch, CSRF_SALT_SIZE + token.length(), out);
+}
+
+// Reverses csrf_mask in place; returns false if the input is not a masked
+// token.
+inline bool csrf_unmask(std::string_view masked, unsigned char *out, size_t &out_len) {
+    size_t decoded_len;
+    if (!base64url_decode(masked, out, decoded_len) || decoded_len <= CSRF_SALT_SIZE) return false;
+
+    unsigned char salt[CSRF_SALT_SIZE];
+    std::memcpy(salt, out, CSRF_SALT_SIZE);
+    out_len = decoded_len - CSRF_SALT_SIZE;
+    for (size_t i = 0; i < out_len; i++) {
+        out[i] = out[CSRF_SALT_SIZE + i] ^ salt[i % CSRF_SALT_SIZE];
+    }
+    return true;
+}
+
+// Returns the value of the cookie called name in a Cookie header, without
+// surrounding quotes, or an empty view with found == false. A name sent
+// twice with different values (cookie tossing from a sibling domain or a
+// narrower path) counts as absent, so no copy is ever preferred.
+inline std::string_view find_cookie(std::string_view header, std::string_view name, bool &found) {
+    found = false;
+    std::string_view result;
+    while (!header.empty()) {
+        size_t semi = header.find(';');
+        std::string_view pair = header.substr(0, semi);
+        header = semi == std::string_view::npos ? std::string_view() : header.substr(semi + 1);
+
+        while (!pair.empty() && (pair.front() == ' ' || pair.front() == '\t')) pair.remove_prefix(1);
+        size_t eq = pair.find('=');
+        if (eq == std::string_view::npos) continue;
+
+        std::string_view key = pair.substr(0, eq);
+        while (!key.empty() && (key.back() == ' ' || key.back() == '\t')) key.remove_suffix(1);
+        if (key != name) continue;
+
+        std::string_view value = pair.substr(eq + 1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+        if (value.length() >= 2 && value.front() == '"' && value.back() == '"') {
+            value = value.substr(1, value.length() - 2);
+        }
+        if (found && value != result) {
+            found = false;
+            return {};
+        }
+        found = true;
+        result = value;
+    }
+    return result;
+}
+
+} // namespace xyra
+
+#endif // XYRA_CSRF_H
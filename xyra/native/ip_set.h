@@ -0,0 +1,302 @@
+#ifndef XYRA_IP_SET_H
+#define XYRA_IP_SET_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+
+namespace xyra {
+
+inline int clz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    for (uint64_t bit = 1ull << 63; !(x & bit); bit >>= 1) n++;
+    return n;
+#endif
+}
+
+// 128-bit address in host order; IPv4 is stored as IPv4-mapped IPv6
+// (::ffff:a.b.c.d) so both families share one trie.
+struct IpKey {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    static uint64_t load_be(const unsigned char *p) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+        return v;
+    }
+
+    static void store_be(uint64_t v, unsigned char *p) {
+        for (int i = 7; i >= 0; i--, v >>= 8) p[i] = (unsigned char) v;
+    }
+
+    // Accepts the binary forms used across the C API (4 or 16 bytes).
+    static bool from_bytes(std::string_view addr, IpKey &out) {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(addr.data());
+        if (addr.length() == 4) {
+            out.hi = 0;
+            out.lo = 0xffff00000000ull | (uint64_t(p[0]) << 24) | (uint64_t(p[1]) << 16) | (uint64_t(p[2]) << 8) | p[3];
+            return true;
+        }
+        if (addr.length() == 16) {
+            out.hi = load_be(p);
+            out.lo = load_be(p + 8);
+            return true;
+        }
+        return false;
+    }
+
+    // Parses a textual IPv4 or IPv6 address. Ports, brackets and zone ids
+    // are not accepted here; callers strip them first.
+    static bool from_text(std::string_view text, IpKey &out) {
+        char buf[64];
+        if (text.empty() || text.length() >= sizeof(buf)) return false;
+        std::memcpy(buf, text.data(), text.length());
+        buf[text.length()] = '\0';
+
+        unsigned char bytes[16];
+        if (text.find(':') == std::string_view::npos) {
+            if (inet_pton(AF_INET, buf, bytes) != 1) return false;
+            return from_bytes(std::string_view((const char *) bytes, 4), out);
+        }
+        if (inet_pton(AF_INET6, buf, bytes) != 1) return false;
+        return from_bytes(std::string_view((const char *) bytes, 16), out);
+    }
+
+    bool is_v4() const { return hi == 0 && (lo >> 32) == 0xffff; }
+
+    // Writes 4 bytes for IPv4 (including mapped) and 16 for IPv6.
+    size_t to_bytes(unsigned char *out) const {
+        if (is_v4()) {
+            uint32_t v4 = (uint32_t) lo;
+            out[0] = (unsigned char) (v4 >> 24);
+            out[1] = (unsigned char) (v4 >> 16);
+            out[2] = (unsigned char) (v4 >> 8);
+            out[3] = (unsigned char) v4;
+            return 4;
+        }
+        store_be(hi, out);
+        store_be(lo, out + 8);
+        return 16;
+    }
+
+    int bit(int i) const {
+        return i < 64 ? int((hi >> (63 - i)) & 1) : int((lo >> (127 - i)) & 1);
+    }
+
+    IpKey masked(int len) const {
+        IpKey k;
+        if (len >= 128) return *this;
+        if (len > 64) {
+            k.hi = hi;
+            k.lo = lo & (~0ull << (128 - len));
+        } else if (len > 0) {
+            k.hi = hi & (len == 64 ? ~0ull : (~0ull << (64 - len)));
+        }
+        return k;
+    }
+
+    bool operator==(const IpKey &other) const { return hi == other.hi && lo == other.lo; }
+
+    // Number of leading bits shared with other.
+    int common_prefix(const IpKey &other) const {
+        uint64_t x = hi ^ other.hi;
+        if (x) return clz64(x);
+        x = lo ^ other.lo;
+        if (x) return 64 + clz64(x);
+        return 128;
+    }
+};
+
+struct IpKeyHash {
+    size_t operator()(const IpKey &key) const {
+        uint64_t h = (key.hi * 0x9e3779b97f4a7c15ull) ^ key.lo;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return size_t(h);
+    }
+};
+
+// Path-compressed binary (Patricia) trie of IPv4/IPv6 prefixes. Membership
+// is a walk of at most one node per branching bit, independent of how many
+// networks are configured. Built once at startup and then only read.
+class IpSet {
+public:
+    bool insert(std::string_view addr, int prefix_len) {
+        IpKey key;
+        if (!IpKey::from_bytes(addr, key)) return false;
+        // Validated against the address family before IPv4 prefixes are
+        // moved into the IPv4-mapped range.
+        int max_len = addr.length() == 4 ? 32 : 128;
+        if (prefix_len < 0 || prefix_len > max_len) return false;
+        if (addr.length() == 4) prefix_len += 96;
+        insert(key.masked(prefix_len), prefix_len);
+        return true;
+    }
+
+    bool contains(const IpKey &key) const {
+        int32_t idx = root_;
+        while (idx != -1) {
+            const Node &n = nodes_[idx];
+            if (key.common_prefix(n.key) < n.len) return false;
+            if (n.terminal) return true;
+            if (n.len == 128) return false;
+            idx = n.child[key.bit(n.len)];
+        }
+        return false;
+    }
+
+    bool contains(std::string_view addr) const {
+        IpKey key;
+        return IpKey::from_bytes(addr, key) && contains(key);
+    }
+
+    bool empty() const { return root_ == -1; }
+
+private:
+    struct Node {
+        IpKey key;
+        int len;
+        bool terminal;
+        int32_t child[2];
+    };
+
+    int32_t make_node(const IpKey &key, int len, bool terminal) {
+        nodes_.push_back(Node{key, len, terminal, {-1, -1}});
+        return int32_t(nodes_.size() - 1);
+    }
+
+    void insert(const IpKey &key, int len) {
+        if (root_ == -1) {
+            root_ = make_node(key, len, true);
+            return;
+        }
+
+        int32_t idx = root_, parent = -1;
+        int dir = 0;
+        for (;;) {
+            // Indices, not references: make_node may reallocate nodes_.
+            int node_len = nodes_[idx].len;
+            IpKey node_key = nodes_[idx].key;
+            int cpl = key.common_prefix(node_key);
+            if (cpl > len) cpl = len;
+            if (cpl > node_len) cpl = node_len;
+
+            if (cpl == node_len) {
+                if (len == node_len) {
+                    nodes_[idx].terminal = true;
+                    return;
+                }
+                int b = key.bit(node_len);
+                if (nodes_[idx].child[b] == -1) {
+                    int32_t leaf = make_node(key, len, true);
+                    nodes_[idx].child[b] = leaf;
+                    return;
+                }
+                parent = idx;
+                dir = b;
+                idx = nodes_[idx].child[b];
+                continue;
+            }
+
+            int32_t split;
+            if (cpl == len) {
+                split = make_node(key, len, true);
+                nodes_[split].child[node_key.bit(len)] = idx;
+            } else {
+                split = make_node(key.masked(cpl), cpl, false);
+                int32_t leaf = make_node(key, len, true);
+                nodes_[split].child[node_key.bit(cpl)] = idx;
+                nodes_[split].child[key.bit(cpl)] = leaf;
+            }
+
+            if (parent == -1) {
+                root_ = split;
+            } else {
+                nodes_[parent].child[dir] = split;
+            }
+            return;
+        }
+    }
+
+    std::vector<Node> nodes_;
+    int32_t root_ = -1;
+};
+
+inline std::string_view trim_ows(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// Extracts the node from the for= parameter of one RFC 7239 Forwarded element,
+// e.g. `for="[2001:db8::17]:4711";proto=https` -> `2001:db8::17`.
+inline std::string_view forwarded_for_node(std::string_view element) {
+    while (!element.empty()) {
+        size_t semi = element.find(';');
+        std::string_view pair = trim_ows(element.substr(0, semi));
+        element = semi == std::string_view::npos ? std::string_view() : element.substr(semi + 1);
+
+        if (pair.length() < 4) continue;
+        if ((pair[0] | 0x20) != 'f' || (pair[1] | 0x20) != 'o' || (pair[2] | 0x20) != 'r' || pair[3] != '=') continue;
+
+        std::string_view node = pair.substr(4);
+        if (node.length() >= 2 && node.front() == '"' && node.back() == '"') {
+            node = node.substr(1, node.length() - 2);
+        }
+        if (!node.empty() && node.front() == '[') {
+            size_t end = node.find(']');
+            return end == std::string_view::npos ? std::string_view() : node.substr(1, end - 1);
+        }
+        size_t colon = node.find(':');
+        if (colon != std::string_view::npos && node.find(':', colon + 1) == std::string_view::npos) {
+            node = node.substr(0, colon); // IPv4 with port
+        }
+        return node;
+    }
+    return {};
+}
+
+// Walks a forwarding chain (X-Forwarded-For, or Forwarded when rfc7239 is set)
+// right to left, skipping hops contained in trusted. Mirrors the Python
+// ProxyHeadersMiddleware: at most max_splits commas are honoured and a fully
+// trusted chain resolves to its leftmost hop.
+//
+// Returns false if the resolved hop is not a valid address (an empty chain
+// included). peeled is set to the number of hops peeled off the right either
+// way, as the Python fallback reports it.
+inline bool resolve_forwarded(const IpSet &trusted, std::string_view chain, bool rfc7239, int max_splits, IpKey &client, int &peeled) {
+    peeled = 0;
+    if (chain.empty()) return false;
+
+    for (;;) {
+        size_t comma = peeled < max_splits ? chain.rfind(',') : std::string_view::npos;
+        std::string_view hop = comma == std::string_view::npos ? chain : chain.substr(comma + 1);
+        bool leftmost = comma == std::string_view::npos;
+
+        hop = trim_ows(hop);
+        if (rfc7239) hop = forwarded_for_node(hop);
+
+        if (!IpKey::from_text(hop, client)) return false;
+        if (leftmost || !trusted.contains(client)) return true;
+
+        chain = chain.substr(0, comma);
+        peeled++;
+    }
+}
+
+} // namespace xyra
+
+#endif // XYRA_IP_SET_H
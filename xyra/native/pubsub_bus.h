@@ -0,0 +1,102 @@
+#ifndef XYRA_PUBSUB_BUS_H
+#define XYRA_PUBSUB_BUS_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace xyra {
+
+// One publish, shared (not copied) by every loop it is delivered to.
+struct BusMessage {
+    std::string topic;
+    std::string payload;
+    int opcode;
+    bool compress;
+};
+
+// Fans topic publishes out to several event loops. uWS pub/sub only reaches
+// sockets on the publishing loop, so each loop joins the bus with a deliver
+// function that hands the message to its own defer queue. Members report
+// their local subscriber count per topic, and loops with no subscribers for
+// a topic are skipped without allocating anything for them.
+class PubSubBus {
+public:
+    using Deliver = std::function<void(const std::shared_ptr<const BusMessage> &)>;
+
+    // deliver is called from the publishing thread and must be thread-safe.
+    uint64_t join(Deliver deliver) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto member = std::make_shared<Member>();
+        member->id = next_id_++;
+        member->deliver = std::move(deliver);
+        members_.push_back(std::move(member));
+        return members_.back()->id;
+    }
+
+    void leave(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < members_.size(); i++) {
+            if (members_[i]->id == id) {
+                members_.erase(members_.begin() + i);
+                return;
+            }
+        }
+    }
+
+    // Records a member's local subscriber count for topic (from the uWS
+    // subscription handler on that member's loop).
+    void set_subscribers(uint64_t id, std::string_view topic, int count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &member : members_) {
+            if (member->id != id) continue;
+            if (count > 0) {
+                member->topics[std::string(topic)] = count;
+            } else {
+                member->topics.erase(std::string(topic));
+            }
+            return;
+        }
+    }
+
+    // Returns the number of loops the message was handed to. skip is a
+    // member that already delivered the message itself (a socket publishing
+    // on its own loop, which has to leave the sender out).
+    size_t publish(std::string_view topic, std::string_view payload, int opcode, bool compress, uint64_t skip = 0) {
+        std::string key(topic);
+        std::vector<std::shared_ptr<Member>> targets;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto &member : members_) {
+                if (member->id != skip && member->topics.count(key)) targets.push_back(member);
+            }
+        }
+        if (targets.empty()) return 0;
+
+        // Deliver outside the lock: a loop publishing to itself may run
+        // uWS callbacks that publish again.
+        auto message = std::make_shared<const BusMessage>(BusMessage{std::move(key), std::string(payload), opcode, compress});
+        for (auto &member : targets) member->deliver(message);
+        return targets.size();
+    }
+
+private:
+    struct Member {
+        uint64_t id;
+        Deliver deliver;
+        std::unordered_map<std::string, int> topics;
+    };
+
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<Member>> members_;
+    uint64_t next_id_ = 1;
+};
+
+} // namespace xyra
+
+#endif // XYRA_PUBSUB_BUS_H
@@ -0,0 +1,170 @@
+#ifndef XYRA_RATE_LIMITER_H
+#define XYRA_RATE_LIMITER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string_view>
+
+namespace xyra {
+
+// Collapses a binary peer address (4 or 16 bytes, as returned by
+// getRemoteAddress) into a 128-bit key. IPv4-mapped IPv6 becomes plain IPv4
+// and native IPv6 is aggregated to its /64, mirroring the Python
+// RateLimitMiddleware key function so rotating through an allocation
+// doesn't reset the bucket.
+inline bool rate_limit_key(std::string_view addr, uint64_t &hi, uint64_t &lo) {
+    static const unsigned char v4_mapped_prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(addr.data());
+    uint32_t v4 = 0;
+
+    if (addr.length() == 4) {
+        std::memcpy(&v4, bytes, 4);
+    } else if (addr.length() == 16 && std::memcmp(bytes, v4_mapped_prefix, 12) == 0) {
+        std::memcpy(&v4, bytes + 12, 4);
+    } else if (addr.length() == 16) {
+        std::memcpy(&hi, bytes, 8);
+        lo = 0;
+        return true;
+    } else {
+        return false;
+    }
+
+    hi = 0;
+    lo = 0xffff00000000ull | v4;
+    return true;
+}
+
+// GCRA (generic cell rate algorithm) limiter: each key holds a single
+// "theoretical arrival time", so a check is one CAS on one word instead of a
+// deque of timestamps. Slots live in a fixed open-addressed table split into
+// shards; nothing is ever locked or rehashed, and expired or least-restrictive
+// slots are recycled in place of the Python limiter's LRU cleanup scans.
+class RateLimiter {
+public:
+    RateLimiter(uint32_t requests, uint32_t window_seconds, size_t max_entries)
+        : requests_(std::max<uint32_t>(requests, 1)) {
+        int64_t window = int64_t(std::max<uint32_t>(window_seconds, 1)) * 1000000000ll;
+        emission_ = std::max<int64_t>(window / requests_, 1);
+        tolerance_ = window - emission_;
+
+        size_t per_shard = std::max<size_t>(max_entries / SHARDS, PROBE);
+        shard_capacity_ = 1;
+        while (shard_capacity_ < per_shard) shard_capacity_ <<= 1;
+        slots_.reset(new Slot[SHARDS * shard_capacity_]);
+
+        std::random_device rd;
+        seed_hi_ = (uint64_t(rd()) << 32) | rd();
+        seed_lo_ = (uint64_t(rd()) << 32) | rd();
+        // Offset the clock by one window so a zeroed slot reads as "idle".
+        epoch_ = std::chrono::steady_clock::now() - std::chrono::nanoseconds(window);
+    }
+
+    uint32_t limit() const { return requests_; }
+
+    // Returns true when the request is allowed. On rejection retry_after is
+    // the number of whole seconds until the key may send again.
+    bool allow(std::string_view addr, uint32_t *retry_after, uint32_t *remaining) {
+        uint64_t hi, lo;
+        if (!rate_limit_key(addr, hi, lo)) {
+            hi = lo = 0; // unknown peers share one bucket
+        }
+
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch_).count();
+        Slot *slot = acquire(fingerprint(hi, lo));
+
+        int64_t tat = slot->tat.load(std::memory_order_relaxed);
+        for (;;) {
+            int64_t base = std::max(tat, now);
+            if (base - now > tolerance_) {
+                if (retry_after) {
+                    int64_t wait = base - now - tolerance_;
+                    *retry_after = uint32_t(std::max<int64_t>((wait + 999999999) / 1000000000, 1));
+                }
+                if (remaining) *remaining = 0;
+                return false;
+            }
+
+            int64_t next = base + emission_;
+            if (slot->tat.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+                if (remaining) *remaining = uint32_t((tolerance_ - (next - now - emission_)) / emission_);
+                if (retry_after) *retry_after = 0;
+                return true;
+            }
+        }
+    }
+
+private:
+    static constexpr size_t SHARDS = 64;
+    static constexpr size_t PROBE = 8;
+
+    struct Slot {
+        std::atomic<uint64_t> fingerprint{0};
+        std::atomic<int64_t> tat{0};
+    };
+
+    uint64_t fingerprint(uint64_t hi, uint64_t lo) const {
+        // Seeded so clients can't aim keys at a single probe sequence.
+        uint64_t h = (hi ^ seed_hi_) * 0x9e3779b97f4a7c15ull;
+        h ^= (lo ^ seed_lo_) + 0x632be59bd9b4e019ull + (h << 6) + (h >> 2);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h ? h : 1; // zero marks an empty slot
+    }
+
+    Slot *acquire(uint64_t fp) {
+        Slot *shard = slots_.get() + (fp >> 58) * shard_capacity_;
+        size_t mask = shard_capacity_ - 1;
+        Slot *victim = nullptr;
+        int64_t victim_tat = std::numeric_limits<int64_t>::max();
+
+        for (size_t i = 0; i < PROBE; i++) {
+            Slot *slot = &shard[(fp + i) & mask];
+            uint64_t current = slot->fingerprint.load(std::memory_order_acquire);
+            if (current == fp) return slot;
+
+            if (current == 0) {
+                if (slot->fingerprint.compare_exchange_strong(current, fp, std::memory_order_acq_rel)) {
+                    return slot;
+                }
+                if (current == fp) return slot;
+            }
+
+            int64_t tat = slot->tat.load(std::memory_order_relaxed);
+            if (tat < victim_tat) {
+                victim = slot;
+                victim_tat = tat;
+            }
+        }
+
+        // Probe window is full: take over the slot nearest to (or past) expiry.
+        uint64_t previous = victim->fingerprint.load(std::memory_order_acquire);
+        if (victim->fingerprint.compare_exchange_strong(previous, fp, std::memory_order_acq_rel)) {
+            victim->tat.store(0, std::memory_order_relaxed);
+        }
+        return victim;
+    }
+
+    uint32_t requests_;
+    int64_t emission_;
+    int64_t tolerance_;
+    size_t shard_capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    uint64_t seed_hi_;
+    uint64_t seed_lo_;
+    std::chrono::steady_clock::time_point epoch_;
+};
+
+} // namespace xyra
+
+#endif // XYRA_RATE_LIMITER_H
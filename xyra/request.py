@@ -12,7 +12,7 @@ except ImportError:
     import json as json_lib
 
 try:
-    from ._libxyra import ffi, lib
+    from ._native import ffi, lib
 except ImportError:
     ffi = None
     lib = None
@@ -17,7 +17,7 @@ import re
 _COOKIE_QUOTE_RE = re.compile(r'["\s,;]')
 
 try:
-    from ._libxyra import ffi, lib
+    from ._native import ffi, lib
 except ImportError:
     ffi = None
     lib = None
@@ -567,7 +567,7 @@ class Response:
                 ffi = None
                 lib = None
             else:
-                from ._libxyra import ffi, lib
+                from ._native import ffi, lib
         except (ImportError, Exception):
             ffi = None
             lib = None
@@ -1,6 +1,6 @@
 try:
 
-    from ._libxyra import ffi, lib
+    from ._native import ffi, lib
 
     def parse_path(path_str):
         params = []
@@ -50,7 +50,9 @@ class Router:
         self.routes = []
         self._route_map: dict[str, dict] = {}
 
-    def add_route(self, method: str, path: str, handler) -> None:
+    def add_route(
+        self, method: str, path: str, handler, max_body_size: int | None = None
+    ) -> None:
         """
         Add a new route to the router.
 
@@ -58,6 +60,7 @@ class Router:
             method: HTTP method (GET, POST, etc.).
             path: URL path pattern.
             handler: Function to handle requests for this route.
+            max_body_size: Optional Content-Length cap overriding the app limit.
         """
         parsed_path, param_names = parse_path(path)
         route_dict = {
@@ -66,6 +69,7 @@ class Router:
             "parsed_path": parsed_path,
             "param_names": param_names,
             "handler": handler,
+            "max_body_size": max_body_size,
         }
         self.routes.append(route_dict)
 
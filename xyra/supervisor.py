@@ -0,0 +1,198 @@
+import json
+import os
+import signal
+import subprocess  # nosec B404
+import sys
+import threading
+import time
+from typing import Any
+
+from .logger import get_logger
+
+# Environment of worker processes: marks them as workers (so they bind
+# alongside each other instead of checking for a free port) and numbers them.
+WORKER_ENV = "XYRA_WORKER_ID"
+
+# A worker that exits sooner than this after starting counts as crashing;
+# its restarts are delayed with exponential backoff up to MAX_BACKOFF.
+MIN_UPTIME = 1.0
+MAX_BACKOFF = 10.0
+
+
+def is_worker() -> bool:
+    """True inside a process started by Supervisor."""
+    return WORKER_ENV in os.environ
+
+
+class Worker:
+    def __init__(self, worker_id: int):
+        self.id = worker_id
+        self.proc: subprocess.Popen | None = None
+        self.started_at = 0.0
+        self.restarts = 0
+        self.crashes = 0
+        self.next_start = 0.0
+
+    @property
+    def alive(self) -> bool:
+        return self.proc is not None and self.proc.poll() is None
+
+    def status(self) -> dict[str, Any]:
+        return {
+            "id": self.id,
+            "pid": self.proc.pid if self.proc else None,
+            "alive": self.alive,
+            "uptime": round(time.monotonic() - self.started_at, 1) if self.alive else 0,
+            "restarts": self.restarts,
+        }
+
+
+class Supervisor:
+    """
+    Runs N worker processes that share one port and keeps them running.
+
+    Workers are separate interpreters, so CPU-bound handlers scale past the
+    GIL. Each re-executes the command line with WORKER_ENV set and binds
+    the same port; uSockets sets SO_REUSEPORT, so the kernel spreads new
+    connections across them. Workers are spawned rather than forked: the
+    native event loop is created with the App at import time and must not
+    be shared across fork.
+
+    Exited workers (crashes, or recycling after max requests) are replaced;
+    SIGTERM/SIGINT drain all workers, SIGHUP restarts them one at a time.
+    """
+
+    def __init__(
+        self,
+        command: list[str],
+        workers: int,
+        graceful_timeout: float = 30.0,
+        health_file: str | None = None,
+    ):
+        if workers < 1:
+            raise ValueError("workers must be at least 1")
+        self.command = command
+        self.workers = [Worker(i) for i in range(workers)]
+        self.graceful_timeout = graceful_timeout
+        self.health_file = health_file
+        self._stopping = threading.Event()
+        self._rolling = threading.Event()
+        self._logger = get_logger("xyra")
+
+    def _spawn(self, worker: Worker) -> None:
+        env = os.environ.copy()
+        env[WORKER_ENV] = str(worker.id)
+        worker.proc = subprocess.Popen(self.command, env=env)  # nosec B603
+        worker.started_at = time.monotonic()
+        self._logger.info(f"Started worker {worker.id} [{worker.proc.pid}]")
+
+    def _reap(self, worker: Worker) -> None:
+        """Schedule a replacement for an exited worker."""
+        code = worker.proc.returncode
+        uptime = time.monotonic() - worker.started_at
+        worker.proc = None
+        worker.restarts += 1
+        if uptime < MIN_UPTIME:
+            worker.crashes += 1
+            delay = min(MAX_BACKOFF, 0.5 * 2 ** (worker.crashes - 1))
+            self._logger.error(f"Worker {worker.id} exited with {code} after {uptime:.1f}s; retrying in {delay:.1f}s")
+            worker.next_start = time.monotonic() + delay
+        else:
+            worker.crashes = 0
+            self._logger.info(f"Worker {worker.id} exited with {code}; restarting")
+            worker.next_start = 0.0
+
+    def check(self) -> None:
+        """Replace exited workers; one supervisor tick."""
+        now = time.monotonic()
+        for worker in self.workers:
+            if worker.proc is not None and worker.proc.poll() is not None:
+                self._reap(worker)
+            if worker.proc is None and now >= worker.next_start:
+                self._spawn(worker)
+        if self.health_file:
+            self._write_health()
+
+    def status(self) -> dict[str, Any]:
+        """Aggregated health: healthy while every worker is running."""
+        workers = [worker.status() for worker in self.workers]
+        alive = sum(1 for worker in workers if worker["alive"])
+        return {
+            "pid": os.getpid(),
+            "healthy": alive == len(workers),
+            "workers_alive": alive,
+            "workers_total": len(workers),
+            "workers": workers,
+        }
+
+    def _write_health(self) -> None:
+        tmp = f"{self.health_file}.tmp"
+        with open(tmp, "w") as f:
+            json.dump(self.status(), f)
+        os.replace(tmp, self.health_file)
+
+    def rolling_restart(self) -> None:
+        """Restart workers one at a time; the others keep serving meanwhile."""
+        for worker in self.workers:
+            if self._stopping.is_set():
+                return
+            # Local reference: check() on the main thread reaps the worker
+            proc = worker.proc
+            if proc is not None and proc.poll() is None:
+                proc.terminate()
+                try:
+                    proc.wait(self.graceful_timeout + 5)
+                except subprocess.TimeoutExpired:
+                    proc.kill()
+                    proc.wait()
+            # check() spawns the replacement on its next tick
+            while not self._stopping.is_set() and (worker.proc is proc or not worker.alive):
+                time.sleep(0.1)
+        self._rolling.clear()
+
+    def stop(self) -> None:
+        """Drain every worker (SIGTERM), killing those past the grace period."""
+        self._stopping.set()
+        procs = [worker.proc for worker in self.workers if worker.alive]
+        for proc in procs:
+            proc.terminate()
+        deadline = time.monotonic() + self.graceful_timeout + 5
+        for proc in procs:
+            try:
+                proc.wait(max(0.0, deadline - time.monotonic()))
+            except subprocess.TimeoutExpired:
+                proc.kill()
+                proc.wait()
+
+    def run(self) -> None:
+        """Start the workers and supervise them until SIGTERM or SIGINT."""
+        def on_stop(signum, frame):
+            self._stopping.set()
+
+        def on_sighup(signum, frame):
+            if not self._rolling.is_set():
+                self._rolling.set()
+                threading.Thread(target=self.rolling_restart, daemon=True).start()
+
+        previous = {signal.SIGTERM: signal.signal(signal.SIGTERM, on_stop)}
+        previous[signal.SIGINT] = signal.signal(signal.SIGINT, on_stop)
+        if hasattr(signal, "SIGHUP"):
+            previous[signal.SIGHUP] = signal.signal(signal.SIGHUP, on_sighup)
+
+        self._logger.info(f"Supervisor [{os.getpid()}] starting {len(self.workers)} workers")
+        try:
+            while not self._stopping.is_set():
+                self.check()
+                self._stopping.wait(0.5)
+        finally:
+            self._logger.info("Stopping workers")
+            self.stop()
+            for signum, handler in previous.items():
+                signal.signal(signum, handler)
+
+
+def worker_command() -> list[str]:
+    """The command line that started this process, as a module run."""
+    if os.path.basename(sys.argv[0]) == "__main__.py":
+        return [sys.executable, "-E", "-m", "xyra"] + sys.argv[1:]
+    return [sys.executable, "-E"] + sys.argv
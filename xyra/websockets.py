@@ -1,33 +1,329 @@
+import asyncio
+import inspect
+import weakref
+from collections.abc import Callable, Iterable
+from enum import IntEnum
 from typing import Any
 
+from .logger import get_logger
+
 try:
 
-    from ._libxyra import ffi, lib
+    from ._native import ffi, lib
 except ImportError:
-    pass
+    ffi = None
+    lib = None
+
+
+class SendStatus(IntEnum):
+    """Outcome of WebSocket.send, mirroring xyra_ws_send_status_t."""
+
+    BACKPRESSURE = 0
+    SUCCESS = 1
+    DROPPED = 2
+
+# permessage-deflate settings, mirroring xyra_ws_compression_t in c_api.h.
+# A compressor and a decompressor may be combined, e.g.
+# ("dedicated_compressor_4kb", "shared_decompressor").
+WS_COMPRESSION = {
+    "disabled": 0,
+    "shared_compressor": 1,
+    "shared_decompressor": 256,
+    "shared": 1 | 256,
+    "dedicated_compressor_3kb": 145,
+    "dedicated_compressor_4kb": 146,
+    "dedicated_compressor_8kb": 163,
+    "dedicated_compressor_16kb": 180,
+    "dedicated_compressor_32kb": 197,
+    "dedicated_compressor_64kb": 214,
+    "dedicated_compressor_128kb": 231,
+    "dedicated_compressor_256kb": 248,
+    "dedicated_compressor": 248,
+    "dedicated_decompressor_512b": 2304,
+    "dedicated_decompressor_1kb": 2560,
+    "dedicated_decompressor_2kb": 2816,
+    "dedicated_decompressor_4kb": 3072,
+    "dedicated_decompressor_8kb": 3328,
+    "dedicated_decompressor_16kb": 3584,
+    "dedicated_decompressor_32kb": 3840,
+    "dedicated_decompressor": 3840,
+}
+
+# uWS::CompressOptions keeps the compressor in the low byte and the
+# decompressor in the high byte; only one of each is meaningful.
+_WS_COMPRESSOR_MASK = 0x00FF
+_WS_DECOMPRESSOR_MASK = 0xFF00
+_WS_COMPRESSORS = {v & _WS_COMPRESSOR_MASK for v in WS_COMPRESSION.values()}
+_WS_DECOMPRESSORS = {v & _WS_DECOMPRESSOR_MASK for v in WS_COMPRESSION.values()}
+
+# uWS defaults; App.websocket(options=...) overrides individual keys.
+WS_DEFAULT_OPTIONS = {
+    "compression": 0,
+    "max_payload_length": 16 * 1024,
+    "idle_timeout": 120,
+    "max_backpressure": 64 * 1024,
+    "close_on_backpressure_limit": False,
+    "reset_idle_timeout_on_send": False,
+    "send_pings_automatically": True,
+    # Batched delivery: flush after this many messages / bytes (0 = only at
+    # the end of each event loop iteration). Setting either enables batching.
+    "batch_max_messages": 0,
+    "batch_max_bytes": 0,
+    # Minutes after which a connection is closed regardless of activity (0 = never).
+    "max_lifetime": 0,
+    # Messages larger than this many bytes are written from the native buffer
+    # to a temporary file, which the message handler receives instead of
+    # str/bytes (0 = never spool).
+    "spool_threshold": 0,
+}
+
+# Options applied by the Python binding rather than passed to xyra_app_ws.
+WS_PYTHON_OPTIONS = frozenset({"spool_threshold"})
+
+
+def resolve_ws_options(options: dict[str, Any] | None) -> dict[str, Any]:
+    """
+    Validate WebSocket behaviour options and fill in the defaults.
+
+    compression may be a name from WS_COMPRESSION, a sequence of names, or
+    the raw integer value, with at most one compressor and one decompressor.
+    Raises ValueError on unknown keys or values.
+    """
+    resolved = dict(WS_DEFAULT_OPTIONS)
+    for key, value in (options or {}).items():
+        if key not in resolved:
+            raise ValueError(f"Unknown WebSocket option: {key}")
+        resolved[key] = value
+
+    compression = resolved["compression"]
+    if isinstance(compression, str):
+        compression = (compression,)
+    if not isinstance(compression, int):
+        flags = 0
+        for name in compression:
+            if name not in WS_COMPRESSION:
+                raise ValueError(f"Unknown WebSocket compression: {name}")
+            value = WS_COMPRESSION[name]
+            if flags & _WS_COMPRESSOR_MASK and value & _WS_COMPRESSOR_MASK:
+                raise ValueError("WebSocket compression takes at most one compressor")
+            if flags & _WS_DECOMPRESSOR_MASK and value & _WS_DECOMPRESSOR_MASK:
+                raise ValueError("WebSocket compression takes at most one decompressor")
+            flags |= value
+        compression = flags
+    if (
+        not 0 <= compression <= 0xFFFF
+        or compression & _WS_COMPRESSOR_MASK not in _WS_COMPRESSORS
+        or compression & _WS_DECOMPRESSOR_MASK not in _WS_DECOMPRESSORS
+    ):
+        raise ValueError(f"Invalid WebSocket compression value: {compression}")
+    resolved["compression"] = compression
+
+    # uWS terminates the process on idle timeouts between 1 and 7 seconds
+    idle_timeout = resolved["idle_timeout"]
+    if idle_timeout != 0 and not 8 <= idle_timeout <= 0xFFFF:
+        raise ValueError("idle_timeout must be 0 or between 8 and 65535 seconds")
+    # usockets long timeouts (used for the lifetime cap) count at most 240 minutes
+    if not 0 <= resolved["max_lifetime"] <= 240:
+        raise ValueError("max_lifetime must be between 0 and 240 minutes")
+    if resolved["spool_threshold"] < 0:
+        raise ValueError("spool_threshold must not be negative")
+    for key in ("max_payload_length", "max_backpressure", "batch_max_messages", "batch_max_bytes"):
+        if not 0 <= resolved[key] <= 0xFFFFFFFF:
+            raise ValueError(f"{key} must be between 0 and 2**32 - 1")
+
+    return resolved
+
+
+class PreparedMessage:
+    """
+    A message framed once and sent to many sockets with WebSocket.send_prepared.
+
+    Use it to fan out to an explicit list of recipients; for topics use
+    publish. With compress=True the message is deflated once for routes
+    using the "shared_compressor" option; dedicated compressors keep state
+    per connection and still deflate each recipient's copy.
+    """
+
+    def __init__(self, message: str | bytes, is_binary: bool = False, compress: bool = False):
+        self.message = message
+        self.is_binary = is_binary
+        self.compress = compress
+        if lib is not None and getattr(lib, "xyra_prepared_message_create", None) is not None:
+            c_msg = message.encode("utf-8") if isinstance(message, str) else message
+            self._native = ffi.gc(
+                lib.xyra_prepared_message_create(c_msg, len(c_msg), 2 if is_binary else 1, compress),
+                lib.xyra_prepared_message_destroy,
+            )
+        else:
+            self._native = None
+
+
+# ws.state dicts. Natively the dict's cffi handle sits in the socket's user
+# data slot and is only kept alive here (keyed by handle address) until the
+# socket closes; other socket objects map to their dict directly.
+_state_handles: dict[int, Any] = {}
+_fallback_states = weakref.WeakKeyDictionary()
+
+
+def release_state(ws: Any) -> None:
+    """Drop the ws.state of a native socket; called once its close handler returned."""
+    ptr = lib.xyra_ws_get_user_data(ws)
+    if ptr != ffi.NULL:
+        lib.xyra_ws_set_user_data(ws, ffi.NULL)
+        _state_handles.pop(int(ffi.cast("uintptr_t", ptr)), None)
+
 
 class WebSocket:
-    def __init__(self, ws: Any):
+    def __init__(self, ws: Any, owner: Any = None):
         self._ws = ws
+        # App the socket belongs to, for publishes through a Python PubSubBus
+        self._owner = owner
+        # Natively the handle would be freed after the close callback; a
+        # reference keeps it valid (and every call on it a no-op once closed)
+        # for as long as this wrapper is kept.
+        self._ref = None
+        if (
+            ws is not None
+            and not hasattr(ws, "send")
+            and ffi is not None
+            and getattr(lib, "xyra_ws_retain", None) is not None
+        ):
+            self._ref = ffi.gc(lib.xyra_ws_retain(ws), lib.xyra_ws_release)
+
+    @property
+    def id(self) -> int:
+        """Connection id, unique for the app's lifetime and stable across callbacks."""
+        if hasattr(self._ws, "send"):
+            return id(self._ws)
+        return lib.xyra_ws_get_id(self._ws)
+
+    @property
+    def state(self) -> dict[str, Any]:
+        """
+        Per-connection dict for application data, the same object in every
+        callback of this socket until it closes.
+        """
+        if hasattr(self._ws, "send"):
+            state = _fallback_states.get(self._ws)
+            if state is None:
+                state = _fallback_states[self._ws] = {}
+            return state
 
-    def send(self, message: str | bytes, is_binary: bool = False) -> None:
-        """Send a message to the WebSocket client."""
+        ptr = lib.xyra_ws_get_user_data(self._ws)
+        if ptr != ffi.NULL:
+            return ffi.from_handle(ptr)
+        state = {}
+        if self.closed:
+            # release_state has run; a handle stored now would never be freed
+            return state
+        handle = ffi.new_handle(state)
+        _state_handles[int(ffi.cast("uintptr_t", handle))] = handle
+        lib.xyra_ws_set_user_data(self._ws, handle)
+        return state
+
+    def send(self, message: str | bytes, is_binary: bool = False) -> SendStatus:
+        """
+        Send a message to the WebSocket client.
+
+        Returns SendStatus.BACKPRESSURE when the message had to be queued
+        behind earlier data; producers should then wait for the "drain"
+        handler (or watch buffered_amount) before sending more.
+        """
         if hasattr(self._ws, "send"):
-            self._ws.send(message, is_binary)
+            status = self._ws.send(message, is_binary)
         else:
             if isinstance(message, str):
                 c_msg = message.encode('utf-8')
             else:
                 c_msg = message
-            lib.xyra_ws_send(self._ws, c_msg, len(c_msg), is_binary)
+            status = lib.xyra_ws_send(self._ws, c_msg, len(c_msg), is_binary)
+        return SendStatus(status)
+
+    def send_fragments(self, chunks: Iterable[str | bytes], is_binary: bool = True) -> SendStatus:
+        """
+        Send one message made of several chunks, each written as a
+        continuation frame as soon as it is produced, so a large payload
+        never has to be joined in memory. Returns the status of the last frame.
+
+        If the chunks raise, or a frame is dropped, after the message has
+        started, the client cannot be sent anything else until it ends: the
+        connection is closed with 1011 (the exception is re-raised, a drop
+        returns SendStatus.DROPPED).
+        """
+        if hasattr(self._ws, "send"):
+            parts = [c.encode("utf-8") if isinstance(c, str) else c for c in chunks]
+            return self.send(b"".join(parts), is_binary)
+
+        started = False
+        pending = None
+        try:
+            for chunk in chunks:
+                if pending is not None:
+                    status = SendStatus(
+                        lib.xyra_ws_send_fragment(self._ws, pending, len(pending), is_binary, not started, False)
+                    )
+                    if status is SendStatus.DROPPED:
+                        break
+                    started = True
+                pending = chunk.encode("utf-8") if isinstance(chunk, str) else chunk
+            else:
+                if pending is None:
+                    pending = b""
+                return SendStatus(
+                    lib.xyra_ws_send_fragment(self._ws, pending, len(pending), is_binary, not started, True)
+                )
+        except BaseException:
+            if started:
+                lib.xyra_ws_end(self._ws, 1011, b"", 0)
+            raise
+        if started:
+            lib.xyra_ws_end(self._ws, 1011, b"", 0)
+        return SendStatus.DROPPED
 
-    def send_text(self, message: str) -> None:
+    def ping(self, message: str | bytes = b"") -> SendStatus:
+        """
+        Send a ping frame (payload up to 125 bytes). The client's answer is
+        reported to the route's "pong" handler. Without the native extension
+        the wrapped socket must have a ping method of its own.
+        """
+        c_msg = message.encode("utf-8") if isinstance(message, str) else message
+        if hasattr(self._ws, "send"):
+            if not hasattr(self._ws, "ping"):
+                raise RuntimeError("WebSocket.ping requires the native extension")
+            status = self._ws.ping(c_msg)
+        else:
+            status = lib.xyra_ws_ping(self._ws, c_msg, len(c_msg))
+        return SendStatus(status)
+
+    @property
+    def idle_time(self) -> float:
+        """Seconds since the client last sent a message, ping or pong."""
+        if hasattr(self._ws, "send"):
+            return 0.0
+        return lib.xyra_ws_get_idle_ms(self._ws) / 1000
+
+    def send_text(self, message: str) -> SendStatus:
         """Send a text message to the WebSocket client."""
-        self.send(message, False)
+        return self.send(message, False)
 
-    def send_binary(self, message: bytes) -> None:
+    def send_binary(self, message: bytes) -> SendStatus:
         """Send binary data to the WebSocket client."""
-        self.send(message, True)
+        return self.send(message, True)
+
+    def send_prepared(self, prepared: PreparedMessage) -> SendStatus:
+        """Send a PreparedMessage without re-encoding it for this socket."""
+        if prepared._native is None or hasattr(self._ws, "send"):
+            return self.send(prepared.message, prepared.is_binary)
+        return SendStatus(lib.xyra_ws_send_prepared(self._ws, prepared._native))
+
+    @property
+    def buffered_amount(self) -> int:
+        """Bytes queued for this client but not yet written to the socket."""
+        if hasattr(self._ws, "get_buffered_amount"):
+            return self._ws.get_buffered_amount()
+        if hasattr(self._ws, "send"):
+            return 0
+        return lib.xyra_ws_get_buffered_amount(self._ws)
 
     def close(self, code: int = 1000, message: str | None = None) -> None:
         """Close the WebSocket connection."""
@@ -46,6 +342,10 @@ class WebSocket:
         """Publish a message to a topic."""
         if hasattr(self._ws, "publish"):
             self._ws.publish(topic, message, is_binary, compress)
+            # Natively xyra_ws_publish goes through the app's bus itself
+            bus = getattr(self._owner, "_pubsub", None)
+            if bus is not None and bus._native is None:
+                bus._publish_from(self._owner, topic, message, is_binary, compress)
         else:
             c_topic = topic.encode('utf-8')
             c_msg = message.encode('utf-8') if isinstance(message, str) else message
@@ -80,3 +380,232 @@ class WebSocket:
         except Exception:
             return True
 
+
+
+# xyra_ws_op_t in c_api.h
+_WS_OP_SEND = 0
+_WS_OP_PUBLISH = 1
+_WS_OP_CLOSE = 2
+_WS_OP_SUBSCRIBE = 3
+_WS_OP_UNSUBSCRIBE = 4
+
+
+class DeferredWebSocket(WebSocket):
+    """
+    Handle passed to async WebSocket handlers, which run on the asyncio loop
+    instead of the uWS thread.
+
+    It holds the app and connection id rather than a native socket pointer:
+    each operation is copied onto the app's event loop and dropped there if
+    the socket has closed in the meantime.
+    """
+
+    def __init__(self, app_ptr: Any, conn_id: int):
+        super().__init__(None)
+        self._app_ptr = app_ptr
+        self._id = conn_id
+        self._state = {}
+        self._closed = False
+
+    @property
+    def id(self) -> int:
+        """Connection id, unique for the app's lifetime."""
+        return self._id
+
+    @property
+    def state(self) -> dict[str, Any]:
+        """Per-connection dict for application data."""
+        return self._state
+
+    def _defer(self, op: int, topic: bytes = b"", message: bytes = b"", opcode: int = 0, compress: bool = False):
+        lib.xyra_ws_defer(
+            self._app_ptr, self.id, op, topic, len(topic), message, len(message), opcode, compress
+        )
+
+    def send(self, message: str | bytes, is_binary: bool = False) -> SendStatus:
+        """
+        Queue a message for the client.
+
+        The send happens later on the event loop, so the result is always
+        SendStatus.SUCCESS (queued); backpressure is reported via "drain".
+        """
+        c_msg = message.encode("utf-8") if isinstance(message, str) else message
+        self._defer(_WS_OP_SEND, message=c_msg, opcode=2 if is_binary else 1)
+        return SendStatus.SUCCESS
+
+    def send_prepared(self, prepared: PreparedMessage) -> SendStatus:
+        """Queue a PreparedMessage (re-framed on the loop for this socket)."""
+        return self.send(prepared.message, prepared.is_binary)
+
+    def send_fragments(self, chunks: Iterable[str | bytes], is_binary: bool = True) -> SendStatus:
+        """Queue the chunks as one message (joined, since other sends may interleave)."""
+        parts = [c.encode("utf-8") if isinstance(c, str) else c for c in chunks]
+        return self.send(b"".join(parts), is_binary)
+
+    def ping(self, message: str | bytes = b"") -> SendStatus:
+        """Queue a ping frame; always SendStatus.SUCCESS (queued)."""
+        c_msg = message.encode("utf-8") if isinstance(message, str) else message
+        self._defer(_WS_OP_SEND, message=c_msg, opcode=9)
+        return SendStatus.SUCCESS
+
+    @property
+    def idle_time(self) -> float:
+        """Not observable off the event loop thread; always 0."""
+        return 0.0
+
+    @property
+    def buffered_amount(self) -> int:
+        """Not observable off the event loop thread; always 0."""
+        return 0
+
+    def close(self, code: int = 1000, message: str | None = None) -> None:
+        """Close the WebSocket connection."""
+        self._defer(_WS_OP_CLOSE)
+
+    def publish(
+        self,
+        topic: str,
+        message: str,
+        is_binary: bool = False,
+        compress: bool = False,
+    ) -> None:
+        """Publish a message to a topic."""
+        c_msg = message.encode("utf-8") if isinstance(message, str) else message
+        self._defer(
+            _WS_OP_PUBLISH, topic.encode("utf-8"), c_msg, 2 if is_binary else 1, compress
+        )
+
+    def subscribe(self, topic: str) -> None:
+        """Subscribe to a topic."""
+        self._defer(_WS_OP_SUBSCRIBE, topic.encode("utf-8"))
+
+    def unsubscribe(self, topic: str) -> None:
+        """Unsubscribe from a topic."""
+        self._defer(_WS_OP_UNSUBSCRIBE, topic.encode("utf-8"))
+
+    @property
+    def closed(self) -> bool:
+        """True once the close handler has been dispatched."""
+        return self._closed
+
+
+class AsyncDispatcher:
+    """
+    Runs a WebSocket route's handlers on an asyncio loop.
+
+    The uWS callbacks only hand events over (call_soon_threadsafe); each
+    socket's events are chained, so its open, messages and close run in
+    order even while a handler is awaiting. Handlers may be sync or async.
+
+    key_of maps the native socket to a stable key, and make_handle builds
+    the object handlers receive for it.
+    """
+
+    def __init__(
+        self,
+        handlers: dict[str, Callable],
+        get_loop: Callable[[], asyncio.AbstractEventLoop],
+        key_of: Callable[[Any], Any],
+        make_handle: Callable[[Any, Any], WebSocket],
+    ):
+        self._handlers = handlers
+        self._get_loop = get_loop
+        self._key_of = key_of
+        self._make_handle = make_handle
+        # key -> [handle, tail task]; the dict is only touched on the uWS
+        # thread, the tail only on the asyncio thread.
+        self._sockets = {}
+
+    def _state(self, ws: Any, pop: bool = False) -> list:
+        key = self._key_of(ws)
+        state = self._sockets.pop(key, None) if pop else self._sockets.get(key)
+        if state is None:
+            state = [self._make_handle(ws, key), None]
+            if not pop:
+                self._sockets[key] = state
+        return state
+
+    def open(self, ws: Any) -> None:
+        self._dispatch(self._state(ws), "open")
+
+    def message(self, ws: Any, message: str | bytes, opcode: int) -> None:
+        self._dispatch(self._state(ws), "message", message, opcode)
+
+    def drain(self, ws: Any) -> None:
+        self._dispatch(self._state(ws), "drain")
+
+    def ping(self, ws: Any, message: bytes) -> None:
+        self._dispatch(self._state(ws), "ping", message)
+
+    def pong(self, ws: Any, message: bytes) -> None:
+        self._dispatch(self._state(ws), "pong", message)
+
+    def close(self, ws: Any, code: int, message: bytes) -> None:
+        state = self._state(ws, pop=True)
+        if isinstance(state[0], DeferredWebSocket):
+            state[0]._closed = True
+        self._dispatch(state, "close", code, message)
+
+    def _dispatch(self, state: list, event: str, *args) -> None:
+        handler = self._handlers.get(event)
+        if handler is None:
+            return
+        loop = self._get_loop()
+        loop.call_soon_threadsafe(self._enqueue, loop, state, handler, (state[0], *args))
+
+    def _enqueue(self, loop, state, handler, args) -> None:
+        state[1] = loop.create_task(self._run(state[1], handler, args))
+
+    @staticmethod
+    async def _run(previous, handler, args) -> None:
+        if previous is not None:
+            await asyncio.wait([previous])
+        try:
+            result = handler(*args)
+            if inspect.isawaitable(result):
+                await result
+        except Exception:
+            get_logger("xyra").exception("Unhandled error in WebSocket handler")
+
+
+class PubSubBus:
+    """
+    Topic fan-out across several Apps running on their own threads.
+
+    uWS pub/sub only reaches sockets on the publishing event loop. Apps that
+    join the same bus (App.join_pubsub) receive each other's publishes; the
+    message is copied once and only queued to loops that have subscribers
+    for the topic.
+    """
+
+    def __init__(self):
+        self._apps = []
+        if lib is not None and getattr(lib, "xyra_pubsub_create", None) is not None:
+            self._native = ffi.gc(lib.xyra_pubsub_create(), lib.xyra_pubsub_destroy)
+        else:
+            self._native = None
+
+    def publish(
+        self,
+        topic: str,
+        message: str | bytes,
+        is_binary: bool = False,
+        compress: bool = False,
+    ) -> int:
+        """Publish to every joined App; returns the number of loops reached."""
+        if self._native is None:
+            for app in self._apps:
+                app._app.publish(topic, message, is_binary, compress)
+            return len(self._apps)
+
+        c_topic = topic.encode("utf-8")
+        c_msg = message.encode("utf-8") if isinstance(message, str) else message
+        return lib.xyra_pubsub_publish(
+            self._native, c_topic, len(c_topic), c_msg, len(c_msg), 2 if is_binary else 1, compress
+        )
+
+    def _publish_from(self, sender: Any, topic: str, message: str | bytes, is_binary: bool, compress: bool) -> None:
+        """Reach every joined App but sender, whose socket already published locally."""
+        for app in self._apps:
+            if app is not sender:
+                app._app.publish(topic, message, is_binary, compress)